@@ -0,0 +1,232 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <ConcurrentCatalog.h>
+#include <Tle.h>
+#include <SGP4.h>
+#include <Util.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * readers propagate every satellite in their snapshot while one updater
+ * cycles the catalog through drops built from the verification set. run it
+ * in a build with SGP4_THREAD_SANITIZER on to check the lock free
+ * publication and reclamation of catalog versions
+ */
+
+namespace
+{
+    std::atomic<unsigned long> g_errors(0);
+
+    void Fail(const std::string& message)
+    {
+        if (g_errors.fetch_add(1) < 10)
+        {
+            std::cerr << "Error: " << message << std::endl;
+        }
+    }
+
+    /*
+     * the element sets of the verification file whose propagators
+     * initialise, as catalogs reject a drop containing a bad one. only the
+     * first of any repeated norad number is kept so each drop has a known
+     * size
+     */
+    std::vector<Tle> LoadTles(const char* infile)
+    {
+        std::vector<Tle> tles;
+        std::set<unsigned int> numbers;
+        std::ifstream file(infile);
+        if (!file.is_open())
+        {
+            return tles;
+        }
+
+        std::string line1;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            Util::Trim(line);
+            if (line.empty() || line[0] == '#')
+            {
+                line1.clear();
+                continue;
+            }
+
+            if (line1.empty())
+            {
+                line1 = line;
+                continue;
+            }
+
+            try
+            {
+                Tle tle("Test", line1, line.substr(0, Tle::LineLength()));
+                SGP4 sgp4(tle);
+                if (numbers.insert(tle.NoradNumber()).second)
+                {
+                    tles.push_back(tle);
+                }
+            }
+            catch (TleException&)
+            {
+            }
+            catch (SatelliteException&)
+            {
+            }
+            line1.clear();
+        }
+
+        return tles;
+    }
+
+    /*
+     * propagate everything in one snapshot, checking the version is one
+     * of the drops and stays intact while it is held
+     */
+    void ReadSnapshot(const ConcurrentCatalog& catalog,
+            const std::vector<size_t>& sizes,
+            double tsince)
+    {
+        ConcurrentCatalog::Snapshot snapshot(catalog);
+
+        bool known_size = false;
+        for (size_t i = 0; i < sizes.size(); i++)
+        {
+            known_size = known_size || snapshot->Size() == sizes[i];
+        }
+        if (!known_size)
+        {
+            Fail("snapshot does not match any drop");
+        }
+
+        size_t count = 0;
+        for (Catalog::const_iterator itr = snapshot->begin();
+                itr != snapshot->end(); ++itr)
+        {
+            if (itr->second->GetTle().NoradNumber() != itr->first)
+            {
+                Fail("entry filed under the wrong norad number");
+            }
+
+            try
+            {
+                itr->second->GetSGP4().FindPosition(tsince);
+            }
+            catch (SatelliteException&)
+            {
+            }
+            catch (DecayedException&)
+            {
+            }
+            count++;
+        }
+
+        if (count != snapshot->Size())
+        {
+            Fail("snapshot changed while held");
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* file_name = argc > 1 ? argv[1] : "../SGP4-VER.TLE";
+    const unsigned int num_readers = argc > 2 ? atoi(argv[2]) : 8;
+    const unsigned int num_updates = argc > 3 ? atoi(argv[3]) : 200;
+
+    const std::vector<Tle> tles = LoadTles(file_name);
+    if (tles.empty())
+    {
+        std::cerr << "Error opening file" << std::endl;
+        return 1;
+    }
+
+    /*
+     * the whole set and its two halves, so that each update adds, removes
+     * and keeps satellites
+     */
+    std::vector<std::vector<Tle> > drops(3);
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        drops[0].push_back(tles[i]);
+        drops[1 + i % 2].push_back(tles[i]);
+    }
+
+    std::vector<size_t> sizes;
+    sizes.push_back(0);
+    for (size_t i = 0; i < drops.size(); i++)
+    {
+        sizes.push_back(drops[i].size());
+    }
+
+    ConcurrentCatalog catalog(num_readers);
+    std::atomic<bool> done(false);
+    std::atomic<unsigned long> snapshots(0);
+
+    std::vector<std::thread> readers;
+    for (unsigned int i = 0; i < num_readers; i++)
+    {
+        readers.push_back(std::thread([&, i]()
+                    {
+                        double tsince = 10.0 * i;
+                        while (!done.load())
+                        {
+                            ReadSnapshot(catalog, sizes, tsince);
+                            tsince += 1.0;
+                            snapshots++;
+                        }
+                    }));
+    }
+
+    for (unsigned int i = 0; i < num_updates; i++)
+    {
+        const std::vector<Tle>& drop = drops[i % drops.size()];
+        const CatalogUpdate update = catalog.Update(drop);
+        if (update.added.size() + update.updated.size() + update.unchanged
+                != drop.size())
+        {
+            Fail("update does not account for every element set");
+        }
+    }
+
+    done.store(true);
+    for (size_t i = 0; i < readers.size(); i++)
+    {
+        readers[i].join();
+    }
+
+    const size_t waiting = catalog.Reclaim();
+    if (waiting != 0)
+    {
+        Fail("versions not reclaimed after the readers finished");
+    }
+
+    std::cout << tles.size() << " satellites, " << num_updates
+        << " updates, " << snapshots.load() << " snapshots, "
+        << g_errors.load() << " errors" << std::endl;
+
+    return g_errors.load() == 0 ? 0 : 1;
+}
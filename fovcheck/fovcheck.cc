@@ -0,0 +1,328 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <CoordGeodetic.h>
+#include <CoordTopocentric.h>
+#include <DateTime.h>
+#include <DecayedException.h>
+#include <FieldOfViewIndex.h>
+#include <Globals.h>
+#include <Observer.h>
+#include <SatelliteException.h>
+#include <SGP4.h>
+#include <Tle.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * compares FieldOfViewIndex::Query with a scan of the whole catalog through
+ * Observer::GetLookAngle, for cones of many sizes and directions at times
+ * spread across several snapshot steps, both forwards and backwards. the
+ * catalog is made up of shells of low earth orbits, navigation,
+ * geostationary and highly elliptical orbits, and an object which has
+ * decayed by the query times. fails if any query finds different objects
+ * or look angles
+ */
+
+namespace
+{
+    static const double kTimeStep = 60.0;
+
+    /*
+     * a set of orbits sharing a mean motion, inclination and eccentricity,
+     * spread evenly over planes and slots within each plane
+     */
+    struct Shell
+    {
+        double mean_motion;
+        double inclination;
+        double eccentricity;
+        double argument_perigee;
+        int planes;
+        int slots;
+    };
+
+    Tle MakeTle(unsigned int norad_number,
+            const Shell& shell,
+            double right_ascending_node,
+            double mean_anomaly)
+    {
+        std::string line1 = "1 00000U 08264A   08264.51782528 "
+            "-.00002182  00000-0 -11606-4 0  2927";
+        char number[6];
+        snprintf(number, sizeof(number), "%05u", norad_number);
+        line1.replace(2, 5, number);
+
+        char line2[70];
+        snprintf(line2, sizeof(line2),
+                "2 %05u %8.4f %8.4f %07d %8.4f %8.4f %11.8f%5d%1d",
+                norad_number,
+                shell.inclination,
+                right_ascending_node,
+                static_cast<int>(shell.eccentricity * 1.0e7 + 0.5),
+                shell.argument_perigee,
+                mean_anomaly,
+                shell.mean_motion,
+                0,
+                0);
+
+        return Tle(line1, line2);
+    }
+
+    std::vector<SGP4> MakeCatalog()
+    {
+        const Shell shells[] = {
+            { 15.50, 51.6, 0.0005, 0.0, 24, 30 },
+            { 15.20, 97.6, 0.0010, 90.0, 18, 24 },
+            { 14.34, 86.4, 0.0002, 0.0, 6, 11 },
+            { 12.80, 52.0, 0.0010, 0.0, 12, 20 },
+            { 2.0056, 55.0, 0.0050, 0.0, 6, 5 },
+            { 1.0027, 0.05, 0.0002, 0.0, 1, 72 },
+            { 2.0060, 63.4, 0.7200, 270.0, 8, 4 } };
+        const size_t num_shells = sizeof(shells) / sizeof(shells[0]);
+
+        std::vector<SGP4> catalog;
+        unsigned int norad_number = 1;
+        for (size_t i = 0; i < num_shells; i++)
+        {
+            const Shell& shell = shells[i];
+            for (int plane = 0; plane < shell.planes; plane++)
+            {
+                for (int slot = 0; slot < shell.slots; slot++)
+                {
+                    /*
+                     * stagger the slots of neighbouring planes
+                     */
+                    const double raan = 360.0 * plane / shell.planes;
+                    const double mean_anomaly = fmod(360.0 * slot / shell.slots
+                            + 7.0 * plane, 360.0);
+                    catalog.push_back(SGP4(MakeTle(norad_number++,
+                                    shell, raan, mean_anomaly)));
+                }
+            }
+        }
+
+        /*
+         * decayed three years before the query times
+         */
+        catalog.push_back(SGP4(Tle("MINOTAUR",
+                        "1 28872U 05037B   05333.02012661  .25992681  "
+                        "00000-0  24476-3 0  1534",
+                        "2 28872  96.4736 157.9986 0303955 244.0492 "
+                        "110.6523 16.46015938 10708")));
+
+        return catalog;
+    }
+
+    bool InsideCone(const CoordTopocentric& look,
+            double azimuth,
+            double elevation,
+            double half_angle)
+    {
+        const double cos_el = cos(elevation);
+        const double look_cos_el = cos(look.elevation);
+        const double cos_separation =
+            look_cos_el * sin(look.azimuth) * cos_el * sin(azimuth)
+            + look_cos_el * cos(look.azimuth) * cos_el * cos(azimuth)
+            + sin(look.elevation) * sin(elevation);
+        return cos_separation >= cos(half_angle);
+    }
+
+    /*
+     * every object inside the cone, in catalog order
+     */
+    std::vector<FieldOfViewHit> Scan(const std::vector<SGP4>& catalog,
+            const Observer& observer,
+            const DateTime& dt,
+            double azimuth,
+            double elevation,
+            double half_angle)
+    {
+        std::vector<FieldOfViewHit> hits;
+        for (size_t i = 0; i < catalog.size(); i++)
+        {
+            FieldOfViewHit hit;
+            hit.object = i;
+            try
+            {
+                hit.look_angle =
+                    observer.GetLookAngle(catalog[i].FindPosition(dt));
+            }
+            catch (SatelliteException&)
+            {
+                continue;
+            }
+            catch (DecayedException&)
+            {
+                continue;
+            }
+
+            if (InsideCone(hit.look_angle, azimuth, elevation, half_angle))
+            {
+                hits.push_back(hit);
+            }
+        }
+        return hits;
+    }
+
+    bool SameHits(const std::vector<FieldOfViewHit>& hits1,
+            const std::vector<FieldOfViewHit>& hits2)
+    {
+        if (hits1.size() != hits2.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < hits1.size(); i++)
+        {
+            const CoordTopocentric& look1 = hits1[i].look_angle;
+            const CoordTopocentric& look2 = hits2[i].look_angle;
+            if (hits1[i].object != hits2[i].object
+                    || look1.azimuth != look2.azimuth
+                    || look1.elevation != look2.elevation
+                    || look1.range != look2.range)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+     * query times, spread unevenly across several steps with jumps back
+     */
+    std::vector<DateTime> QueryTimes(const DateTime& start)
+    {
+        std::vector<DateTime> times;
+        for (int i = 0; i < 40; i++)
+        {
+            times.push_back(start.AddSeconds(7.3 * i));
+        }
+        for (int i = 0; i < 10; i++)
+        {
+            times.push_back(start.AddSeconds(300.0 - 23.9 * i));
+        }
+        times.push_back(start.AddSeconds(kTimeStep / 2.0));
+        times.push_back(start.AddSeconds(3600.0));
+        times.push_back(start);
+        return times;
+    }
+}
+
+int main()
+{
+    const std::vector<SGP4> catalog = MakeCatalog();
+
+    const CoordGeodetic stations[] = {
+        CoordGeodetic(51.5, -0.1, 0.05),
+        CoordGeodetic(78.2, 15.4, 0.5),
+        CoordGeodetic(-33.9, 151.2, 0.0) };
+    const size_t num_stations = sizeof(stations) / sizeof(stations[0]);
+
+    const double half_angles[] = { 0.5, 2.0, 10.0, 45.0, 180.0 };
+    const size_t num_half_angles =
+        sizeof(half_angles) / sizeof(half_angles[0]);
+
+    const std::vector<DateTime> times =
+        QueryTimes(DateTime(2008, 9, 20, 18, 0, 0));
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    size_t queries = 0;
+    size_t hits = 0;
+    size_t failures = 0;
+    for (size_t s = 0; s < num_stations; s++)
+    {
+        const Observer observer(stations[s]);
+        FieldOfViewIndex index(catalog, stations[s]);
+        index.SetTimeStep(kTimeStep);
+
+        for (size_t t = 0; t < times.size(); t++)
+        {
+            for (size_t h = 0; h < num_half_angles; h++)
+            {
+                /*
+                 * directions spread evenly over the sky, with the zenith
+                 * and nadir in every few
+                 */
+                const double azimuth = kTWOPI * unit(random);
+                double elevation = asin(2.0 * unit(random) - 1.0);
+                if (t % 5 == 0)
+                {
+                    elevation = (h % 2 == 0 ? 0.5 : -0.5) * kPI;
+                }
+                const double half_angle = half_angles[h] * kPI / 180.0;
+
+                const std::vector<FieldOfViewHit> expected = Scan(catalog,
+                        observer, times[t], azimuth, elevation, half_angle);
+                const std::vector<FieldOfViewHit> found = index.Query(
+                        times[t], azimuth, elevation, half_angle);
+
+                if (!SameHits(expected, found))
+                {
+                    if (failures < 10)
+                    {
+                        std::cerr << "Error: " << found.size()
+                            << " objects found where the scan found "
+                            << expected.size() << " at " << times[t]
+                            << " from " << stations[s] << std::endl;
+                    }
+                    failures++;
+                }
+                queries++;
+                hits += expected.size();
+            }
+        }
+    }
+
+    /*
+     * a step which is not positive is refused
+     */
+    FieldOfViewIndex index(catalog, stations[0]);
+    const double bad_steps[] = { 0.0, -kTimeStep };
+    for (size_t i = 0; i < sizeof(bad_steps) / sizeof(bad_steps[0]); i++)
+    {
+        try
+        {
+            index.SetTimeStep(bad_steps[i]);
+            std::cerr << "Error: time step of " << bad_steps[i]
+                << " seconds accepted" << std::endl;
+            failures++;
+        }
+        catch (std::invalid_argument&)
+        {
+        }
+    }
+
+    std::cout << catalog.size() << " objects, " << queries << " queries, "
+        << hits << " hits" << std::endl;
+
+    if (failures > 0)
+    {
+        std::cerr << "Error: " << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
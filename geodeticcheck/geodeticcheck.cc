@@ -0,0 +1,133 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <CoordGeodetic.h>
+#include <DateTime.h>
+#include <Eci.h>
+#include <GeodeticBatch.h>
+
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/*
+ * compares GeodeticBatch::Convert with Eci::ToGeodetic over a sweep of
+ * latitudes, longitudes and altitudes, from the surface out to lunar
+ * distance and including the poles. fails if any position differs by a
+ * millimetre or more
+ */
+
+namespace
+{
+    static const double kTolerance = 1.0e-6;
+
+    /*
+     * distance in kilometres between the points two geodetic positions
+     * describe, so that errors in longitude near the poles count for as
+     * little as they move the point
+     */
+    double Separation(const DateTime& dt,
+            double gmst,
+            const CoordGeodetic& geo1,
+            const CoordGeodetic& geo2)
+    {
+        const Eci eci1(dt, geo1, gmst);
+        const Eci eci2(dt, geo2, gmst);
+        return (eci1.Position() - eci2.Position()).Magnitude();
+    }
+}
+
+int main()
+{
+    std::vector<double> latitudes;
+    for (int i = -180; i <= 180; i++)
+    {
+        latitudes.push_back(0.5 * i);
+    }
+    latitudes.push_back(-89.9999);
+    latitudes.push_back(89.9999);
+    latitudes.push_back(-0.0001);
+    latitudes.push_back(0.0001);
+
+    std::vector<double> longitudes;
+    for (int i = -180; i < 180; i += 15)
+    {
+        longitudes.push_back(i + 0.25);
+    }
+
+    /*
+     * low earth orbit, navigation, geostationary, highly elliptical
+     * apogees and lunar distance
+     */
+    const double altitudes[] = { 0.0, 0.001, 1.0, 100.0, 400.0, 1000.0,
+        5000.0, 20200.0, 35786.0, 100000.0, 384400.0 };
+    const size_t num_altitudes = sizeof(altitudes) / sizeof(altitudes[0]);
+
+    const DateTime dt(2020, 3, 20, 12, 34, 56);
+    const double gmst = dt.ToGreenwichSiderealTime();
+
+    std::vector<Eci> states;
+    for (size_t i = 0; i < latitudes.size(); i++)
+    {
+        for (size_t j = 0; j < longitudes.size(); j++)
+        {
+            for (size_t k = 0; k < num_altitudes; k++)
+            {
+                states.push_back(Eci(dt,
+                            CoordGeodetic(latitudes[i], longitudes[j],
+                                altitudes[k]),
+                            gmst));
+            }
+        }
+    }
+
+    std::vector<CoordGeodetic> batch;
+    GeodeticBatch::Convert(states, std::vector<double>(states.size(), gmst),
+            batch);
+
+    double worst = 0.0;
+    size_t worst_index = 0;
+    size_t failures = 0;
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        const CoordGeodetic reference = states[i].ToGeodetic(gmst);
+        const double error = Separation(dt, gmst, reference, batch[i]);
+        if (error >= kTolerance)
+        {
+            failures++;
+        }
+        if (error > worst)
+        {
+            worst = error;
+            worst_index = i;
+        }
+    }
+
+    std::cout << states.size() << " positions, worst difference "
+        << std::setprecision(3) << worst * 1.0e6 << " mm at "
+        << states[worst_index].ToGeodetic(gmst) << std::endl;
+
+    if (failures > 0)
+    {
+        std::cerr << "Error: " << failures
+            << " positions differ by a millimetre or more" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,351 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "AccessEngine.h"
+
+#include "Eci.h"
+#include "SiderealGrid.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /*
+     * allowance for the difference between geodetic and geocentric
+     * latitude, and for the osculating orbit moving outside the mean one
+     */
+    static const double kLatitudeMargin = 0.5 * kPI / 180.0;
+    static const double kRadiusMargin = 1.05;
+
+    /*
+     * time steps propagated at once, sharing one sidereal time evaluation
+     */
+    static const size_t kStepsPerFill = 32;
+
+    /*
+     * refined times are accurate to this many seconds
+     */
+    static const double kTimeTolerance = 0.01;
+    static const int kMaxIterations = 32;
+}
+
+/*
+ * in the triangle of the earths centre, the ground point and the satellite,
+ * the angle at the ground point is 90 degrees plus the elevation and the
+ * angle at the satellite is the angle off nadir. the sine rule gives the
+ * angle at the centre for either limit, taking the tighter
+ */
+double SensorCone::FootprintAngle(double radius) const
+{
+    const double ratio = kXKMPER * cos(min_elevation_) / radius;
+    if (ratio >= 1.0)
+    {
+        return -1.0;
+    }
+    double angle = acos(ratio) - min_elevation_;
+
+    /*
+     * a cone reaching past the horizon does not limit the footprint
+     */
+    const double cone = radius * sin(half_angle_) / kXKMPER;
+    if (cone < 1.0)
+    {
+        angle = std::min(angle, asin(cone) - half_angle_);
+    }
+
+    return angle;
+}
+
+std::vector<RegionAccess> AccessEngine::FindAccesses(
+        const std::vector<SGP4>& satellites,
+        const std::vector<AccessRegion>& regions,
+        const DateTime& start_time,
+        const DateTime& end_time,
+        std::vector<size_t>* failed) const
+{
+    std::vector<std::vector<RegionAccess> > task_accesses(satellites.size());
+    std::vector<char> task_failed(satellites.size(), 0);
+
+    WorkStealingPool pool(thread_count_);
+    pool.Run(satellites.size(), [&](size_t satellite)
+            {
+                try
+                {
+                    SearchSatellite(satellites[satellite], satellite,
+                            regions, start_time, end_time,
+                            task_accesses[satellite]);
+                }
+                catch (SatelliteException&)
+                {
+                    task_failed[satellite] = 1;
+                }
+                catch (DecayedException&)
+                {
+                    task_failed[satellite] = 1;
+                }
+            });
+
+    if (failed != NULL)
+    {
+        failed->clear();
+    }
+
+    std::vector<RegionAccess> accesses;
+    for (size_t satellite = 0; satellite < satellites.size(); satellite++)
+    {
+        if (task_failed[satellite])
+        {
+            if (failed != NULL)
+            {
+                failed->push_back(satellite);
+            }
+            continue;
+        }
+        accesses.insert(accesses.end(),
+                task_accesses[satellite].begin(),
+                task_accesses[satellite].end());
+    }
+
+    return accesses;
+}
+
+/*
+ * step one satellite along, checking its footprint against every region it
+ * could reach. the ground track stays within the inclination of the
+ * equator, so a region further than the widest footprint beyond that can
+ * never be seen
+ */
+void AccessEngine::SearchSatellite(
+        const SGP4& sgp4,
+        size_t satellite,
+        const std::vector<AccessRegion>& regions,
+        const DateTime& start_time,
+        const DateTime& end_time,
+        std::vector<RegionAccess>& accesses) const
+{
+    const OrbitalElements& elements = sgp4.GetOrbitalElements();
+    const double inclination = elements.Inclination();
+    const double max_latitude =
+        std::min(inclination, kPI - inclination) + kLatitudeMargin;
+    const double apogee = elements.RecoveredSemiMajorAxis()
+        * (1.0 + elements.Eccentricity()) * kXKMPER * kRadiusMargin;
+    const double max_angle = sensor_.FootprintAngle(apogee);
+    if (max_angle < 0.0)
+    {
+        return;
+    }
+
+    std::vector<size_t> candidates;
+    for (size_t j = 0; j < regions.size(); j++)
+    {
+        if (regions[j].South() - max_angle <= max_latitude
+                && regions[j].North() + max_angle >= -max_latitude)
+        {
+            candidates.push_back(j);
+        }
+    }
+
+    if (candidates.empty())
+    {
+        return;
+    }
+
+    std::vector<bool> inside(candidates.size(), false);
+    std::vector<DateTime> entry_times(candidates.size());
+    std::vector<std::vector<RegionAccess> > region_accesses(
+            candidates.size());
+
+    /*
+     * check the sub satellite point at one time against every candidate,
+     * refining any change since the previous time
+     */
+    bool first = true;
+    DateTime previous_time;
+    auto sample = [&](const DateTime& time, const CoordGeodetic& geo)
+    {
+        const double angle = sensor_.FootprintAngle(kXKMPER + geo.altitude);
+
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            const AccessRegion& region = regions[candidates[i]];
+            const bool seen = angle >= 0.0
+                && region.MayReach(geo.latitude, geo.longitude, angle)
+                && region.Distance(geo.latitude, geo.longitude) <= angle;
+            if (seen == inside[i])
+            {
+                continue;
+            }
+
+            DateTime crossing = start_time;
+            if (!first)
+            {
+                crossing = FindCrossingPoint(sgp4, region,
+                        previous_time, time);
+            }
+
+            if (seen)
+            {
+                entry_times[i] = crossing;
+            }
+            else
+            {
+                RegionAccess access;
+                access.satellite = satellite;
+                access.region = candidates[i];
+                access.start = entry_times[i];
+                access.end = crossing;
+                region_accesses[i].push_back(access);
+            }
+            inside[i] = seen;
+        }
+
+        first = false;
+        previous_time = time;
+    };
+
+    SiderealGrid sidereal;
+    SGP4::IntegratorParams integrator;
+    unsigned long step = 0;
+    while (SiderealGrid::TimeOf(start_time, time_step_, step) < end_time)
+    {
+        size_t count = 0;
+        while (count < kStepsPerFill
+                && SiderealGrid::TimeOf(start_time, time_step_, step + count)
+                < end_time)
+        {
+            count++;
+        }
+        sidereal.Fill(start_time, time_step_, step, count);
+
+        for (unsigned long point = step; point < step + count; point++)
+        {
+            const DateTime time =
+                SiderealGrid::TimeOf(start_time, time_step_, point);
+            sample(time, sgp4.FindPosition(time, integrator).ToGeodetic(
+                        sidereal.Angle(point)));
+        }
+
+        step += count;
+    }
+
+    /*
+     * the end time is a sample too, so a crossing after the last step is
+     * found
+     */
+    if (!first)
+    {
+        sample(end_time,
+                sgp4.FindPosition(end_time, integrator).ToGeodetic());
+    }
+
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        if (inside[i])
+        {
+            /*
+             * still in view at the end time, so use it as the exit
+             */
+            RegionAccess access;
+            access.satellite = satellite;
+            access.region = candidates[i];
+            access.start = entry_times[i];
+            access.end = end_time;
+            region_accesses[i].push_back(access);
+        }
+
+        accesses.insert(accesses.end(),
+                region_accesses[i].begin(), region_accesses[i].end());
+    }
+}
+
+/*
+ * how far the footprint reaches past the edge of the region, as an earth
+ * central angle. positive while the region can be seen
+ */
+double AccessEngine::Clearance(
+        const SGP4& sgp4,
+        const AccessRegion& region,
+        const DateTime& dt) const
+{
+    const CoordGeodetic geo = sgp4.FindPosition(dt).ToGeodetic();
+    return sensor_.FootprintAngle(kXKMPER + geo.altitude)
+        - region.Distance(geo.latitude, geo.longitude);
+}
+
+/*
+ * find the time at which the clearance changes sign between two times
+ * either side of it. uses the illinois variant of regula falsi, which
+ * keeps the crossing bracketed and converges superlinearly
+ */
+DateTime AccessEngine::FindCrossingPoint(
+        const SGP4& sgp4,
+        const AccessRegion& region,
+        const DateTime& time1,
+        const DateTime& time2) const
+{
+    double t1 = 0.0;
+    double t2 = (time2 - time1).TotalSeconds();
+    double f1 = Clearance(sgp4, region, time1);
+    double f2 = Clearance(sgp4, region, time2);
+    if ((f1 >= 0.0) == (f2 >= 0.0))
+    {
+        return time2;
+    }
+
+    const bool seen1 = f1 >= 0.0;
+    double t = t2;
+    int side = 0;
+
+    for (int cnt = 0; cnt < kMaxIterations; cnt++)
+    {
+        const double previous_t = t;
+        t = (t1 * f2 - t2 * f1) / (f2 - f1);
+
+        const double f = Clearance(sgp4, region, time1.AddSeconds(t));
+
+        if (fabs(t - previous_t) < kTimeTolerance
+                || t2 - t1 < kTimeTolerance)
+        {
+            break;
+        }
+
+        if ((f >= 0.0) == seen1)
+        {
+            t1 = t;
+            f1 = f;
+            if (side == 1)
+            {
+                f2 /= 2.0;
+            }
+            side = 1;
+        }
+        else
+        {
+            t2 = t;
+            f2 = f;
+            if (side == -1)
+            {
+                f1 /= 2.0;
+            }
+            side = -1;
+        }
+    }
+
+    return time1.AddSeconds(t);
+}
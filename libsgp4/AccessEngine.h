@@ -0,0 +1,190 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ACCESSENGINE_H_
+#define ACCESSENGINE_H_
+
+#include "AccessRegion.h"
+#include "DateTime.h"
+#include "Globals.h"
+#include "SGP4.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief The part of the ground a satellite's sensor can see.
+ *
+ * A ground point is seen when it is within the half angle of the satellites
+ * nadir, and the satellite is at least the minimum elevation above the
+ * points horizon. The half angle is that of a nadir pointing cone, or the
+ * furthest off nadir a steerable sensor can point. The earth is taken to
+ * be a sphere.
+ */
+class SensorCone
+{
+public:
+    /**
+     * Constructor for a sensor limited only by the horizon
+     */
+    SensorCone()
+        : half_angle_(kPI / 2.0)
+        , min_elevation_(0.0)
+    {
+    }
+
+    /**
+     * Constructor
+     * @param[in] half_angle the largest angle off nadir in radians
+     * @param[in] min_elevation the minimum elevation in radians
+     */
+    SensorCone(double half_angle, double min_elevation)
+        : half_angle_(half_angle)
+        , min_elevation_(min_elevation)
+    {
+    }
+
+    double HalfAngle() const
+    {
+        return half_angle_;
+    }
+
+    double MinElevation() const
+    {
+        return min_elevation_;
+    }
+
+    /**
+     * @param[in] radius the distance of the satellite from the earth's
+     *            centre in kilometres
+     * @returns the earth central angle radius of the footprint, negative if
+     *          nothing can be seen
+     */
+    double FootprintAngle(double radius) const;
+
+private:
+    double half_angle_;
+    double min_elevation_;
+};
+
+/**
+ * @brief A period during which a satellite can see a region.
+ */
+struct RegionAccess
+{
+    /** index of the satellite */
+    size_t satellite;
+    /** index of the region */
+    size_t region;
+    /** the time the footprint first reaches the region */
+    DateTime start;
+    /** the time the footprint leaves the region */
+    DateTime end;
+};
+
+/**
+ * @brief Finds when satellites can see regions of the earth.
+ *
+ * Each satellite is propagated once per time step. Its sub satellite point
+ * and footprint are shared by every region. A region beyond the latitudes
+ * the ground track can reach is skipped for that satellite without further
+ * work. At each step, a region whose bounds the footprint cannot reach is
+ * rejected before the exact distance is worked out. Entry and exit times
+ * are refined between the steps either side of them. Satellites are split
+ * across a WorkStealingPool, and results do not depend on the number of
+ * threads. A satellite which fails to propagate is left out of the results
+ * rather than stopping the whole search.
+ */
+class AccessEngine
+{
+public:
+    AccessEngine()
+        : time_step_(60.0)
+        , thread_count_(0)
+    {
+    }
+
+    /**
+     * Set the number of threads to search on
+     * @param[in] thread_count the number of threads, or zero for the number
+     *            of hardware threads
+     */
+    void SetThreadCount(unsigned int thread_count)
+    {
+        thread_count_ = thread_count;
+    }
+
+    /**
+     * Set the interval at which the satellites are sampled. Accesses shorter
+     * than this may be missed.
+     * @param[in] seconds the time step in seconds
+     */
+    void SetTimeStep(double seconds)
+    {
+        time_step_ = seconds;
+    }
+
+    /**
+     * Set what the satellites can see
+     * @param[in] sensor the sensor, the same for every satellite
+     */
+    void SetSensor(const SensorCone& sensor)
+    {
+        sensor_ = sensor;
+    }
+
+    /**
+     * Find when each satellite can see each region between two times. An
+     * access in progress at the start or end time is cut short at that
+     * time. Entry and exit times are refined to well under a second.
+     * @param[in] satellites the satellites
+     * @param[in] regions the regions
+     * @param[in] start_time the start of the search period
+     * @param[in] end_time the end of the search period
+     * @param[out] failed if not NULL, receives the indices of satellites
+     *             which failed to propagate, in ascending order. none of
+     *             their accesses are returned
+     * @returns the accesses ordered by satellite, region then time
+     */
+    std::vector<RegionAccess> FindAccesses(
+            const std::vector<SGP4>& satellites,
+            const std::vector<AccessRegion>& regions,
+            const DateTime& start_time,
+            const DateTime& end_time,
+            std::vector<size_t>* failed = NULL) const;
+
+private:
+    void SearchSatellite(const SGP4& sgp4,
+            size_t satellite,
+            const std::vector<AccessRegion>& regions,
+            const DateTime& start_time,
+            const DateTime& end_time,
+            std::vector<RegionAccess>& accesses) const;
+    double Clearance(const SGP4& sgp4,
+            const AccessRegion& region,
+            const DateTime& dt) const;
+    DateTime FindCrossingPoint(const SGP4& sgp4,
+            const AccessRegion& region,
+            const DateTime& time1,
+            const DateTime& time2) const;
+
+    double time_step_;
+    unsigned int thread_count_;
+    SensorCone sensor_;
+};
+
+#endif
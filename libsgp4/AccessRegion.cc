@@ -0,0 +1,322 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "AccessRegion.h"
+
+#include "Globals.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    Vector UnitVector(double latitude, double longitude)
+    {
+        const double cos_lat = cos(latitude);
+        return Vector(cos_lat * cos(longitude),
+                cos_lat * sin(longitude),
+                sin(latitude));
+    }
+
+    Vector Cross(const Vector& a, const Vector& b)
+    {
+        return Vector(a.y * b.z - a.z * b.y,
+                a.z * b.x - a.x * b.z,
+                a.x * b.y - a.y * b.x);
+    }
+
+    double Angle(const Vector& a, const Vector& b)
+    {
+        return atan2(Cross(a, b).Magnitude(), a.Dot(b));
+    }
+
+    /*
+     * unit normal of the great circle through two points, left zero if
+     * they are the same point
+     */
+    Vector Normal(const Vector& a, const Vector& b)
+    {
+        Vector n = Cross(a, b);
+        const double magnitude = n.Magnitude();
+        if (magnitude > 0.0)
+        {
+            n = Vector(n.x / magnitude, n.y / magnitude, n.z / magnitude);
+        }
+        return n;
+    }
+
+    /*
+     * whether a point on the great circle with normal n lies on the arc
+     * from a to b
+     */
+    bool OnArc(const Vector& q, const Vector& a, const Vector& b,
+            const Vector& n)
+    {
+        return Cross(a, q).Dot(n) >= 0.0 && Cross(q, b).Dot(n) >= 0.0;
+    }
+
+    /*
+     * earth central angle from p to the nearest point of the arc from a to
+     * b. the nearest point of the whole great circle is p with its out of
+     * plane part taken away, if that lies on the arc, otherwise an end
+     */
+    double ArcDistance(const Vector& p, const Vector& a, const Vector& b)
+    {
+        const Vector n = Normal(a, b);
+        const double s = p.Dot(n);
+        const Vector q(p.x - s * n.x, p.y - s * n.y, p.z - s * n.z);
+        if (n.Magnitude() > 0.0 && OnArc(q, a, b, n))
+        {
+            return asin(std::min(1.0, fabs(s)));
+        }
+        return std::min(Angle(p, a), Angle(p, b));
+    }
+
+    /*
+     * the highest or lowest latitude along the arc from a to b, where the
+     * great circle peaks between them
+     */
+    void ArcLatitudes(const Vector& a, const Vector& b,
+            double& south, double& north)
+    {
+        const Vector n = Normal(a, b);
+        if (n.Magnitude() == 0.0)
+        {
+            return;
+        }
+
+        const Vector top(-n.z * n.x, -n.z * n.y, 1.0 - n.z * n.z);
+        const double magnitude = top.Magnitude();
+        if (magnitude == 0.0)
+        {
+            return;
+        }
+
+        const Vector unit(top.x / magnitude, top.y / magnitude,
+                top.z / magnitude);
+        if (OnArc(unit, a, b, n))
+        {
+            north = std::max(north, asin(std::min(1.0, unit.z)));
+        }
+        const Vector bottom(-unit.x, -unit.y, -unit.z);
+        if (OnArc(bottom, a, b, n))
+        {
+            south = std::min(south, -asin(std::min(1.0, unit.z)));
+        }
+    }
+}
+
+AccessRegion::AccessRegion(const std::vector<CoordGeodetic>& vertices)
+{
+    if (vertices.size() < 3)
+    {
+        throw std::invalid_argument("A polygon needs at least 3 vertices");
+    }
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        vertices_.push_back(
+                UnitVector(vertices[i].latitude, vertices[i].longitude));
+    }
+
+    /*
+     * the direction the vertices run round the inside, from the polygons
+     * area projected onto the plane across the vertices mean direction
+     */
+    Vector centre;
+    for (size_t i = 0; i < vertices_.size(); i++)
+    {
+        centre.x += vertices_[i].x;
+        centre.y += vertices_[i].y;
+        centre.z += vertices_[i].z;
+    }
+    double area = 0.0;
+    for (size_t i = 0; i < vertices_.size(); i++)
+    {
+        area += Cross(vertices_[i],
+                vertices_[(i + 1) % vertices_.size()]).Dot(centre);
+    }
+    orientation_ = area < 0.0 ? -1.0 : 1.0;
+
+    /*
+     * edges are shorter than 180 degrees, so each runs the short way
+     * round in longitude
+     */
+    south_ = north_ = vertices[0].latitude;
+    double longitude = vertices[0].longitude;
+    double low = longitude;
+    double high = longitude;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const size_t next = (i + 1) % vertices.size();
+        south_ = std::min(south_, vertices[i].latitude);
+        north_ = std::max(north_, vertices[i].latitude);
+        ArcLatitudes(vertices_[i], vertices_[next], south_, north_);
+
+        if (next != 0)
+        {
+            longitude += Util::WrapNegPosPI(
+                    vertices[next].longitude - vertices[i].longitude);
+            low = std::min(low, longitude);
+            high = std::max(high, longitude);
+        }
+    }
+
+    /*
+     * a polygon around a pole covers every longitude
+     */
+    bool all_longitudes = high - low >= kTWOPI;
+    if (Contains(kPI / 2.0, 0.0))
+    {
+        north_ = kPI / 2.0;
+        all_longitudes = true;
+    }
+    if (Contains(-kPI / 2.0, 0.0))
+    {
+        south_ = -kPI / 2.0;
+        all_longitudes = true;
+    }
+
+    if (all_longitudes)
+    {
+        west_ = -kPI;
+        width_ = kTWOPI;
+    }
+    else
+    {
+        west_ = Util::WrapNegPosPI(low);
+        width_ = high - low;
+    }
+}
+
+AccessRegion::AccessRegion(double south, double west, double north, double east)
+    : orientation_(1.0)
+    , south_(south)
+    , north_(north)
+    , west_(west)
+    , width_(east - west)
+{
+    if (south > north)
+    {
+        throw std::invalid_argument("Box south edge is north of north edge");
+    }
+
+    if (width_ < 0.0)
+    {
+        width_ += kTWOPI;
+    }
+}
+
+bool AccessRegion::InLongitudes(double longitude) const
+{
+    return width_ >= kTWOPI || Util::WrapTwoPI(longitude - west_) <= width_;
+}
+
+/*
+ * a point is inside the polygon if the edges wind around it in the same
+ * direction as the vertices run. the angle each edge turns through as seen
+ * from the point is measured in the plane tangent to the earth there, so
+ * the edges also wind around points opposite the polygon, but the other way
+ */
+bool AccessRegion::Contains(double latitude, double longitude) const
+{
+    if (vertices_.empty())
+    {
+        return latitude >= south_ && latitude <= north_
+            && InLongitudes(longitude);
+    }
+
+    const Vector p = UnitVector(latitude, longitude);
+    double winding = 0.0;
+    for (size_t i = 0; i < vertices_.size(); i++)
+    {
+        const Vector& a = vertices_[i];
+        const Vector& b = vertices_[(i + 1) % vertices_.size()];
+        winding += atan2(p.Dot(Cross(a, b)),
+                a.Dot(b) - a.Dot(p) * b.Dot(p));
+    }
+
+    return winding * orientation_ > kPI;
+}
+
+double AccessRegion::Distance(double latitude, double longitude) const
+{
+    if (Contains(latitude, longitude))
+    {
+        return 0.0;
+    }
+
+    const Vector p = UnitVector(latitude, longitude);
+    double distance = std::numeric_limits<double>::max();
+
+    if (vertices_.empty())
+    {
+        /*
+         * the nearest point on a north or south edge is due north or south
+         * if the point is within the box longitudes, otherwise it is a
+         * corner, which is also the end of an east or west edge
+         */
+        if (InLongitudes(longitude))
+        {
+            distance = latitude < south_
+                ? south_ - latitude : latitude - north_;
+        }
+
+        const double east = west_ + width_;
+        distance = std::min(distance, ArcDistance(p,
+                    UnitVector(south_, west_), UnitVector(north_, west_)));
+        distance = std::min(distance, ArcDistance(p,
+                    UnitVector(south_, east), UnitVector(north_, east)));
+        return distance;
+    }
+
+    for (size_t i = 0; i < vertices_.size(); i++)
+    {
+        distance = std::min(distance, ArcDistance(p,
+                    vertices_[i], vertices_[(i + 1) % vertices_.size()]));
+    }
+
+    return distance;
+}
+
+/*
+ * a circle spans its radius either side in latitude. unless it covers a
+ * pole, it spans asin(sin(angle) / cos(latitude)) either side in longitude
+ */
+bool AccessRegion::MayReach(
+        double latitude,
+        double longitude,
+        double angle) const
+{
+    if (latitude + angle < south_ || latitude - angle > north_)
+    {
+        return false;
+    }
+
+    if (width_ >= kTWOPI || fabs(latitude) + angle >= kPI / 2.0)
+    {
+        return true;
+    }
+
+    const double half_width = asin(std::min(1.0, sin(angle) / cos(latitude)));
+    const double west = longitude - half_width;
+    return Util::WrapTwoPI(west - west_) <= width_
+        || Util::WrapTwoPI(west_ - west) <= 2.0 * half_width;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ACCESSREGION_H_
+#define ACCESSREGION_H_
+
+#include "CoordGeodetic.h"
+#include "Vector.h"
+
+#include <vector>
+
+/**
+ * @brief An area of the earths surface, a polygon or a latitude and
+ * longitude box.
+ *
+ * The earth is taken to be a sphere, with geodetic latitudes and longitudes
+ * used as spherical ones. Polygon edges are great circle arcs, and a polygon
+ * must lie within one hemisphere, while the north and south edges of a box
+ * follow lines of latitude. The bounds of the region in latitude and
+ * longitude are kept so that points which cannot be near it are rejected
+ * cheaply.
+ */
+class AccessRegion
+{
+public:
+    /**
+     * Constructor for a polygon. The altitudes of the vertices are ignored.
+     * @param[in] vertices the corners of the polygon in order
+     * @exception std::invalid_argument if there are fewer than 3 vertices
+     */
+    explicit AccessRegion(const std::vector<CoordGeodetic>& vertices);
+
+    /**
+     * Constructor for a box. A box whose west edge is east of its east edge
+     * crosses 180 degrees longitude.
+     * @param[in] south the southern latitude in radians
+     * @param[in] west the western longitude in radians
+     * @param[in] north the northern latitude in radians
+     * @param[in] east the eastern longitude in radians
+     * @exception std::invalid_argument if south is north of north
+     */
+    AccessRegion(double south, double west, double north, double east);
+
+    /**
+     * @returns the southernmost latitude of the region in radians
+     */
+    double South() const
+    {
+        return south_;
+    }
+
+    /**
+     * @returns the northernmost latitude of the region in radians
+     */
+    double North() const
+    {
+        return north_;
+    }
+
+    /**
+     * @param[in] latitude the latitude of the point in radians
+     * @param[in] longitude the longitude of the point in radians
+     * @returns true if the point is inside the region
+     */
+    bool Contains(double latitude, double longitude) const;
+
+    /**
+     * @param[in] latitude the latitude of the point in radians
+     * @param[in] longitude the longitude of the point in radians
+     * @returns the earth central angle from the point to the nearest part of
+     *          the region in radians, zero inside it
+     */
+    double Distance(double latitude, double longitude) const;
+
+    /**
+     * Check against the bounds of the region whether a circle on the
+     * earths surface could overlap it
+     * @param[in] latitude the latitude of the circles centre in radians
+     * @param[in] longitude the longitude of the circles centre in radians
+     * @param[in] angle the earth central angle radius of the circle
+     * @returns false if the circle is clear of the region
+     */
+    bool MayReach(double latitude, double longitude, double angle) const;
+
+private:
+    bool InLongitudes(double longitude) const;
+
+    /** polygon corners as unit vectors, empty for a box */
+    std::vector<Vector> vertices_;
+    /** 1 if the vertices run anticlockwise around the inside, else -1 */
+    double orientation_;
+    double south_;
+    double north_;
+    /** the region lies east of west_ by up to width_ radians */
+    double west_;
+    double width_;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "Catalog.h"
+
+#include <utility>
+
+CatalogUpdate Catalog::Update(const std::vector<Tle>& tles)
+{
+    CatalogUpdate result;
+
+    /*
+     * index the incoming set by norad number, keeping the latest epoch
+     * for any satellite which appears more than once
+     */
+    std::map<unsigned int, const Tle*> incoming;
+    for (std::vector<Tle>::const_iterator itr = tles.begin();
+            itr != tles.end(); ++itr)
+    {
+        std::pair<std::map<unsigned int, const Tle*>::iterator, bool> ins =
+            incoming.insert(std::make_pair(itr->NoradNumber(), &*itr));
+        if (!ins.second && itr->Epoch() >= ins.first->second->Epoch())
+        {
+            ins.first->second = &*itr;
+        }
+    }
+
+    /*
+     * walk both sets in norad order. new propagators are initialised before
+     * anything is modified so a bad element set leaves the catalog untouched
+     */
+    std::vector<std::pair<unsigned int, std::shared_ptr<const CatalogEntry> > >
+        staged;
+    EntryMap::const_iterator current = entries_.begin();
+    std::map<unsigned int, const Tle*>::const_iterator next = incoming.begin();
+
+    while (current != entries_.end() || next != incoming.end())
+    {
+        if (next == incoming.end()
+                || (current != entries_.end() && current->first < next->first))
+        {
+            result.removed.push_back(current->first);
+            ++current;
+        }
+        else if (current == entries_.end() || next->first < current->first)
+        {
+            staged.push_back(std::make_pair(next->first,
+                        std::make_shared<const CatalogEntry>(
+                            CompactTle(*next->second))));
+            result.added.push_back(next->first);
+            ++next;
+        }
+        else
+        {
+            const CompactTle tle(*next->second);
+            if (current->second->GetTle().IsSameElementSet(tle))
+            {
+                result.unchanged++;
+            }
+            else
+            {
+                staged.push_back(std::make_pair(next->first,
+                            std::make_shared<const CatalogEntry>(tle)));
+                result.updated.push_back(next->first);
+            }
+            ++current;
+            ++next;
+        }
+    }
+
+    /*
+     * apply the changes
+     */
+    for (std::vector<unsigned int>::const_iterator itr = result.removed.begin();
+            itr != result.removed.end(); ++itr)
+    {
+        entries_.erase(*itr);
+    }
+
+    for (size_t i = 0; i < staged.size(); i++)
+    {
+        entries_[staged[i].first] = staged[i].second;
+    }
+
+    return result;
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CATALOG_H_
+#define CATALOG_H_
+
+#include "Tle.h"
+#include "CompactTle.h"
+#include "SGP4.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief A satellite in the catalog with its initialised propagator.
+ *
+ * Entries are immutable once created, so they may be shared between
+ * copies of a Catalog.
+ */
+class CatalogEntry
+{
+public:
+    /**
+     * Constructor
+     * @param[in] tle the element set for the satellite
+     * @exception SatelliteException if the elements are invalid
+     */
+    CatalogEntry(const CompactTle& tle)
+        : tle_(tle)
+        , sgp4_(tle.Elements())
+    {
+    }
+
+    /**
+     * @returns the element set the propagator was initialised from
+     */
+    const CompactTle& GetTle() const
+    {
+        return tle_;
+    }
+
+    /**
+     * @returns the initialised propagator
+     */
+    const SGP4& GetSGP4() const
+    {
+        return sgp4_;
+    }
+
+private:
+    CompactTle tle_;
+    SGP4 sgp4_;
+};
+
+/**
+ * @brief Summary of the changes made by Catalog::Update.
+ */
+struct CatalogUpdate
+{
+    CatalogUpdate()
+        : unchanged(0)
+    {
+    }
+
+    /** norad numbers of satellites which were not in the catalog */
+    std::vector<unsigned int> added;
+    /** norad numbers of satellites which were re-initialised */
+    std::vector<unsigned int> updated;
+    /** norad numbers of satellites missing from the new set */
+    std::vector<unsigned int> removed;
+    /** number of satellites whose element set did not change */
+    unsigned int unchanged;
+};
+
+/**
+ * @brief A set of satellites keyed by norad number.
+ *
+ * The catalog is refreshed by passing it a complete element set drop.
+ * Only satellites whose parsed element fields differ from the current
+ * entry, as compared by CompactTle::IsSameElementSet, have their
+ * propagator re-initialised. A change of name alone is not an update.
+ * Element sets are held as CompactTle so the original line text is not
+ * kept.
+ */
+class Catalog
+{
+public:
+    typedef std::map<unsigned int, std::shared_ptr<const CatalogEntry> >
+        EntryMap;
+    typedef EntryMap::const_iterator const_iterator;
+
+    /**
+     * Replace the contents of the catalog with a new element set drop.
+     *
+     * Satellites not present in tles are removed. Where a norad number
+     * appears more than once, the element set with the latest epoch is used.
+     * If any propagator fails to initialise the catalog is left unchanged.
+     * @param[in] tles the complete new element set
+     * @returns the changes that were made
+     * @exception SatelliteException if an element set is invalid
+     */
+    CatalogUpdate Update(const std::vector<Tle>& tles);
+
+    /**
+     * Find a satellite
+     * @param[in] norad_number the satellite to find
+     * @returns the entry, or NULL if it is not in the catalog
+     */
+    const CatalogEntry* Find(unsigned int norad_number) const
+    {
+        const_iterator itr = entries_.find(norad_number);
+        if (itr == entries_.end())
+        {
+            return NULL;
+        }
+        return itr->second.get();
+    }
+
+    /**
+     * @returns the number of satellites in the catalog
+     */
+    size_t Size() const
+    {
+        return entries_.size();
+    }
+
+    const_iterator begin() const
+    {
+        return entries_.begin();
+    }
+
+    const_iterator end() const
+    {
+        return entries_.end();
+    }
+
+private:
+    EntryMap entries_;
+};
+
+#endif
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "CompactTle.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    static const unsigned int TLE1_COL_CLASSIFICATION = 7;
+    static const unsigned int TLE1_COL_EPHEMTYPE = 62;
+    static const unsigned int TLE1_COL_ELNUM = 64;
+    static const unsigned int TLE1_LEN_ELNUM = 4;
+
+    /*
+     * format a value with an assumed leading decimal point, e.g. " .00000484"
+     */
+    void FormatDecimal(char* out, size_t size, double val)
+    {
+        char temp[32];
+        snprintf(temp, sizeof(temp), "%.8f", fabs(val));
+        /*
+         * skip the leading zero
+         */
+        snprintf(out, size, "%c%s", val < 0.0 ? '-' : ' ', temp + 1);
+    }
+
+    /*
+     * format a value with an assumed leading decimal point and a power of
+     * ten exponent, e.g. " 89219-4"
+     */
+    void FormatExponential(char* out, size_t size, double val)
+    {
+        int mantissa = 0;
+        int exponent = 0;
+
+        if (val != 0.0)
+        {
+            exponent = static_cast<int>(floor(log10(fabs(val)))) + 1;
+            mantissa = static_cast<int>(
+                    floor(fabs(val) / pow(10.0, exponent) * 1e5 + 0.5));
+            if (mantissa >= 100000)
+            {
+                mantissa /= 10;
+                exponent++;
+            }
+        }
+
+        snprintf(out, size, "%c%05d%c%d",
+                val < 0.0 ? '-' : ' ',
+                mantissa,
+                exponent > 0 ? '+' : '-',
+                std::abs(exponent) % 10);
+    }
+
+    /*
+     * digits count their value, minus signs count one
+     */
+    char Checksum(const char* line, size_t length)
+    {
+        int sum = 0;
+        for (size_t i = 0; i < length; i++)
+        {
+            if (isdigit(line[i]))
+            {
+                sum += line[i] - '0';
+            }
+            else if (line[i] == '-')
+            {
+                sum++;
+            }
+        }
+        return static_cast<char>('0' + sum % 10);
+    }
+}
+
+CompactTle::CompactTle(const Tle& tle, bool keep_lines)
+{
+    Initialize(tle, keep_lines);
+}
+
+CompactTle::CompactTle(const std::string& name,
+        const std::string& line_one,
+        const std::string& line_two,
+        bool keep_lines)
+{
+    Initialize(Tle(name, line_one, line_two), keep_lines);
+}
+
+void CompactTle::Initialize(const Tle& tle, bool keep_lines)
+{
+    epoch_ = tle.Epoch().Ticks();
+    mean_motion_dt2_ = tle.MeanMotionDt2();
+    mean_motion_ddt6_ = tle.MeanMotionDdt6();
+    bstar_ = tle.BStar();
+    inclination_ = tle.Inclination(true);
+    right_ascending_node_ = tle.RightAscendingNode(true);
+    eccentricity_ = tle.Eccentricity();
+    argument_perigee_ = tle.ArgumentPerigee(true);
+    mean_anomaly_ = tle.MeanAnomaly(true);
+    mean_motion_ = tle.MeanMotion();
+    norad_number_ = tle.NoradNumber();
+    orbit_number_ = tle.OrbitNumber();
+
+    /*
+     * fields the Tle class does not parse
+     */
+    const std::string line_one = tle.Line1();
+    classification_ = line_one[TLE1_COL_CLASSIFICATION];
+    ephemeris_type_ = line_one[TLE1_COL_EPHEMTYPE];
+    element_number_ = 0;
+    for (unsigned int i = TLE1_COL_ELNUM;
+            i < TLE1_COL_ELNUM + TLE1_LEN_ELNUM; i++)
+    {
+        if (isdigit(line_one[i]))
+        {
+            element_number_ = static_cast<uint16_t>(
+                    element_number_ * 10 + (line_one[i] - '0'));
+        }
+    }
+
+    const std::string designator = tle.IntDesignator();
+    std::memset(int_designator_, ' ', sizeof(int_designator_));
+    std::memcpy(int_designator_, designator.data(),
+            std::min(designator.size(), sizeof(int_designator_)));
+
+    const std::string name = tle.Name();
+    std::memset(name_, 0, sizeof(name_));
+    if (name.size() <= sizeof(name_))
+    {
+        std::memcpy(name_, name.data(), name.size());
+    }
+    else
+    {
+        long_name_ = std::make_shared<const std::string>(name);
+    }
+
+    if (keep_lines)
+    {
+        lines_ = std::make_shared<const std::pair<std::string, std::string> >(
+                line_one, tle.Line2());
+    }
+}
+
+std::string CompactTle::Line1() const
+{
+    if (lines_)
+    {
+        return lines_->first;
+    }
+
+    const DateTime epoch = Epoch();
+    const int year = epoch.Year();
+    const double day = 1.0
+        + static_cast<double>(epoch_ - DateTime(year, 1, 1).Ticks())
+        / static_cast<double>(TicksPerDay);
+
+    char dt2[32];
+    char ddt6[32];
+    char bstar[32];
+    FormatDecimal(dt2, sizeof(dt2), mean_motion_dt2_);
+    FormatExponential(ddt6, sizeof(ddt6), mean_motion_ddt6_);
+    FormatExponential(bstar, sizeof(bstar), bstar_);
+
+    char line[160];
+    snprintf(line, sizeof(line),
+            "1 %05u%c %.8s %02d%012.8f %s %s %s %c %4u",
+            norad_number_,
+            classification_,
+            int_designator_,
+            year % 100,
+            day,
+            dt2,
+            ddt6,
+            bstar,
+            ephemeris_type_,
+            static_cast<unsigned int>(element_number_));
+
+    std::string result(line);
+    result += Checksum(line, result.length());
+    return result;
+}
+
+std::string CompactTle::Line2() const
+{
+    if (lines_)
+    {
+        return lines_->second;
+    }
+
+    char line[160];
+    snprintf(line, sizeof(line),
+            "2 %05u %8.4f %8.4f %07d %8.4f %8.4f %11.8f%5u",
+            norad_number_,
+            inclination_,
+            right_ascending_node_,
+            static_cast<int>(floor(eccentricity_ * 1e7 + 0.5)),
+            argument_perigee_,
+            mean_anomaly_,
+            mean_motion_,
+            orbit_number_ % 100000);
+
+    std::string result(line);
+    result += Checksum(line, result.length());
+    return result;
+}
+
+OrbitalElements CompactTle::Elements() const
+{
+    return OrbitalElements(Epoch(),
+            MeanAnomaly(false),
+            RightAscendingNode(false),
+            ArgumentPerigee(false),
+            Eccentricity(),
+            Inclination(false),
+            MeanMotion() * kTWOPI / kMINUTES_PER_DAY,
+            BStar());
+}
+
+bool CompactTle::IsSameElementSet(const CompactTle& tle) const
+{
+    return epoch_ == tle.epoch_
+        && mean_motion_dt2_ == tle.mean_motion_dt2_
+        && mean_motion_ddt6_ == tle.mean_motion_ddt6_
+        && bstar_ == tle.bstar_
+        && inclination_ == tle.inclination_
+        && right_ascending_node_ == tle.right_ascending_node_
+        && eccentricity_ == tle.eccentricity_
+        && argument_perigee_ == tle.argument_perigee_
+        && mean_anomaly_ == tle.mean_anomaly_
+        && mean_motion_ == tle.mean_motion_
+        && norad_number_ == tle.norad_number_
+        && orbit_number_ == tle.orbit_number_
+        && element_number_ == tle.element_number_
+        && classification_ == tle.classification_
+        && ephemeris_type_ == tle.ephemeris_type_
+        && std::memcmp(int_designator_, tle.int_designator_,
+                sizeof(int_designator_)) == 0;
+}
@@ -0,0 +1,265 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef COMPACTTLE_H_
+#define COMPACTTLE_H_
+
+#include "Tle.h"
+#include "OrbitalElements.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <stdint.h>
+
+/**
+ * @brief A parsed two-line element set without per-record strings.
+ *
+ * Holds the same fields as Tle but keeps the international designator and
+ * the satellite name in fixed size arrays. Names longer than the 24
+ * characters of a title line are held on the heap instead. The element
+ * lines are rebuilt from the fields when asked for, unless the original
+ * lines were kept at construction.
+ */
+class CompactTle
+{
+public:
+    /**
+     * Constructor
+     * @param[in] tle the element set to copy
+     * @param[in] keep_lines whether to keep the original element lines
+     */
+    explicit CompactTle(const Tle& tle, bool keep_lines = false);
+
+    /**
+     * @details Initialise given the satellite name and the two lines of a tle
+     * @param[in] name Satellite name
+     * @param[in] line_one Tle line one
+     * @param[in] line_two Tle line two
+     * @param[in] keep_lines whether to keep the original element lines
+     * @exception TleException
+     */
+    CompactTle(const std::string& name,
+            const std::string& line_one,
+            const std::string& line_two,
+            bool keep_lines = false);
+
+    /**
+     * Get the satellite name
+     * @returns the satellite name
+     */
+    std::string Name() const
+    {
+        if (long_name_)
+        {
+            return *long_name_;
+        }
+        return std::string(name_,
+                std::find(name_, name_ + sizeof(name_), '\0'));
+    }
+
+    /**
+     * Get the first line of the tle. Unless the original lines were kept this
+     * is rebuilt from the fields, with a recalculated checksum.
+     * @returns the first line of the tle
+     */
+    std::string Line1() const;
+
+    /**
+     * Get the second line of the tle. Unless the original lines were kept
+     * this is rebuilt from the fields, with a recalculated checksum.
+     * @returns the second line of the tle
+     */
+    std::string Line2() const;
+
+    /**
+     * Get the norad number
+     * @returns the norad number
+     */
+    unsigned int NoradNumber() const
+    {
+        return norad_number_;
+    }
+
+    /**
+     * Get the international designator
+     * @returns the international designator
+     */
+    std::string IntDesignator() const
+    {
+        return std::string(int_designator_, sizeof(int_designator_));
+    }
+
+    /**
+     * Get the tle epoch
+     * @returns the tle epoch
+     */
+    DateTime Epoch() const
+    {
+        return DateTime(epoch_);
+    }
+
+    /**
+     * Get the first time derivative of the mean motion divided by two
+     * @returns the first time derivative of the mean motion divided by two
+     */
+    double MeanMotionDt2() const
+    {
+        return mean_motion_dt2_;
+    }
+
+    /**
+     * Get the second time derivative of mean motion divided by six
+     * @returns the second time derivative of mean motion divided by six
+     */
+    double MeanMotionDdt6() const
+    {
+        return mean_motion_ddt6_;
+    }
+
+    /**
+     * Get the BSTAR drag term
+     * @returns the BSTAR drag term
+     */
+    double BStar() const
+    {
+        return bstar_;
+    }
+
+    /**
+     * Get the inclination
+     * @param in_degrees Whether to return the value in degrees or radians
+     * @returns the inclination
+     */
+    double Inclination(bool in_degrees) const
+    {
+        return in_degrees ? inclination_ : Util::DegreesToRadians(inclination_);
+    }
+
+    /**
+     * Get the right ascension of the ascending node
+     * @param in_degrees Whether to return the value in degrees or radians
+     * @returns the right ascension of the ascending node
+     */
+    double RightAscendingNode(bool in_degrees) const
+    {
+        return in_degrees ? right_ascending_node_
+            : Util::DegreesToRadians(right_ascending_node_);
+    }
+
+    /**
+     * Get the eccentricity
+     * @returns the eccentricity
+     */
+    double Eccentricity() const
+    {
+        return eccentricity_;
+    }
+
+    /**
+     * Get the argument of perigee
+     * @param in_degrees Whether to return the value in degrees or radians
+     * @returns the argument of perigee
+     */
+    double ArgumentPerigee(bool in_degrees) const
+    {
+        return in_degrees ? argument_perigee_
+            : Util::DegreesToRadians(argument_perigee_);
+    }
+
+    /**
+     * Get the mean anomaly
+     * @param in_degrees Whether to return the value in degrees or radians
+     * @returns the mean anomaly
+     */
+    double MeanAnomaly(bool in_degrees) const
+    {
+        return in_degrees ? mean_anomaly_ : Util::DegreesToRadians(mean_anomaly_);
+    }
+
+    /**
+     * Get the mean motion
+     * @returns the mean motion (revolutions per day)
+     */
+    double MeanMotion() const
+    {
+        return mean_motion_;
+    }
+
+    /**
+     * Get the orbit number
+     * @returns the orbit number
+     */
+    unsigned int OrbitNumber() const
+    {
+        return orbit_number_;
+    }
+
+    /**
+     * @returns the orbital elements used to initialise a propagator
+     */
+    OrbitalElements Elements() const;
+
+    /**
+     * @returns the element set as a Tle
+     */
+    Tle ToTle() const
+    {
+        return Tle(Name(), Line1(), Line2());
+    }
+
+    /**
+     * Compare the element fields. The name and any kept lines are ignored.
+     * @param[in] tle the element set to compare with
+     * @returns whether the element sets are the same
+     */
+    bool IsSameElementSet(const CompactTle& tle) const;
+
+private:
+    void Initialize(const Tle& tle, bool keep_lines);
+
+    int64_t epoch_;
+    double mean_motion_dt2_;
+    double mean_motion_ddt6_;
+    double bstar_;
+    double inclination_;
+    double right_ascending_node_;
+    double eccentricity_;
+    double argument_perigee_;
+    double mean_anomaly_;
+    double mean_motion_;
+    uint32_t norad_number_;
+    uint32_t orbit_number_;
+    uint16_t element_number_;
+    char classification_;
+    char ephemeris_type_;
+    char int_designator_[8];
+    /** the name, padded with nulls */
+    char name_[24];
+    /** names too long for name_ */
+    std::shared_ptr<const std::string> long_name_;
+    /** the original lines, only set when requested */
+    std::shared_ptr<const std::pair<std::string, std::string> > lines_;
+};
+
+inline std::ostream& operator<<(std::ostream& strm, const CompactTle& t)
+{
+    return strm << t.ToTle();
+}
+
+#endif
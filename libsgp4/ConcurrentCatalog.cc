@@ -0,0 +1,161 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ConcurrentCatalog.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <thread>
+
+ConcurrentCatalog::ConcurrentCatalog(unsigned int max_readers)
+    : current_(new Catalog())
+    , global_epoch_(1)
+    , slots_(new ReaderSlot[std::max(max_readers, 1u)])
+    , num_slots_(std::max(max_readers, 1u))
+{
+    for (unsigned int i = 0; i < num_slots_; i++)
+    {
+        slots_[i].epoch.store(0);
+    }
+}
+
+ConcurrentCatalog::~ConcurrentCatalog()
+{
+    for (size_t i = 0; i < retired_.size(); i++)
+    {
+        delete retired_[i].catalog;
+    }
+    delete current_.load();
+    delete[] slots_;
+}
+
+ConcurrentCatalog::Snapshot::Snapshot(const ConcurrentCatalog& holder)
+    : holder_(holder)
+    , slot_(holder.AcquireSlot())
+    , catalog_(holder.current_.load())
+{
+}
+
+ConcurrentCatalog::Snapshot::~Snapshot()
+{
+    holder_.ReleaseSlot(slot_);
+}
+
+/*
+ * record the current epoch in a free slot. this must happen before the
+ * catalog pointer is loaded so that the updater either sees the slot or
+ * the reader sees the newly published catalog
+ */
+unsigned int ConcurrentCatalog::AcquireSlot() const
+{
+    const unsigned int start = static_cast<unsigned int>(
+            std::hash<std::thread::id>()(std::this_thread::get_id())
+            % num_slots_);
+
+    while (true)
+    {
+        for (unsigned int i = 0; i < num_slots_; i++)
+        {
+            const unsigned int slot = (start + i) % num_slots_;
+            uint64_t expected = 0;
+            if (slots_[slot].epoch.load(std::memory_order_relaxed) == 0
+                    && slots_[slot].epoch.compare_exchange_strong(
+                        expected, global_epoch_.load()))
+            {
+                return slot;
+            }
+        }
+        /*
+         * every slot is in use
+         */
+        std::this_thread::yield();
+    }
+}
+
+void ConcurrentCatalog::ReleaseSlot(unsigned int slot) const
+{
+    slots_[slot].epoch.store(0, std::memory_order_release);
+}
+
+CatalogUpdate ConcurrentCatalog::Update(const std::vector<Tle>& tles)
+{
+    std::lock_guard<std::mutex> lock(update_mutex_);
+
+    /*
+     * entries are shared between versions, so the copy only duplicates
+     * the index and the update only initialises what changed
+     */
+    const Catalog* previous = current_.load();
+    std::unique_ptr<Catalog> next(new Catalog(*previous));
+    CatalogUpdate result = next->Update(tles);
+
+    current_.store(next.release());
+
+    /*
+     * any reader still able to see the previous version entered with an
+     * epoch before this increment
+     */
+    RetiredVersion retired;
+    retired.catalog = previous;
+    retired.epoch = global_epoch_.fetch_add(1) + 1;
+    retired_.push_back(retired);
+
+    ReclaimRetired();
+
+    return result;
+}
+
+size_t ConcurrentCatalog::Reclaim()
+{
+    std::lock_guard<std::mutex> lock(update_mutex_);
+    return ReclaimRetired();
+}
+
+/*
+ * free retired versions older than the oldest active reader. the caller
+ * must hold update_mutex_
+ */
+size_t ConcurrentCatalog::ReclaimRetired()
+{
+    uint64_t min_epoch = std::numeric_limits<uint64_t>::max();
+    for (unsigned int i = 0; i < num_slots_; i++)
+    {
+        const uint64_t epoch = slots_[i].epoch.load();
+        if (epoch != 0 && epoch < min_epoch)
+        {
+            min_epoch = epoch;
+        }
+    }
+
+    std::vector<RetiredVersion> remaining;
+    for (size_t i = 0; i < retired_.size(); i++)
+    {
+        if (retired_[i].epoch <= min_epoch)
+        {
+            delete retired_[i].catalog;
+        }
+        else
+        {
+            remaining.push_back(retired_[i]);
+        }
+    }
+    retired_.swap(remaining);
+
+    return retired_.size();
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CONCURRENTCATALOG_H_
+#define CONCURRENTCATALOG_H_
+
+#include "Catalog.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * @brief Publishes immutable Catalog versions to concurrent readers.
+ *
+ * Readers pin the current version with a Snapshot without taking a lock.
+ * Updates are applied to a copy of the current version which is then
+ * published atomically. Superseded versions are freed once no reader that
+ * could have seen them is still active (epoch based reclamation).
+ */
+class ConcurrentCatalog
+{
+public:
+    /**
+     * Constructor
+     * @param[in] max_readers the number of snapshots that may be held at
+     *            once. further readers wait for a free slot
+     */
+    explicit ConcurrentCatalog(unsigned int max_readers = 64);
+
+    /**
+     * Destructor. No snapshots may be held when this is called.
+     */
+    ~ConcurrentCatalog();
+
+    /**
+     * @brief A pinned, read only version of the catalog.
+     *
+     * The version remains valid until the snapshot is destroyed. Snapshots
+     * should be short lived as they delay reclamation of old versions.
+     */
+    class Snapshot
+    {
+    public:
+        explicit Snapshot(const ConcurrentCatalog& holder);
+        ~Snapshot();
+
+        const Catalog& operator*() const
+        {
+            return *catalog_;
+        }
+
+        const Catalog* operator->() const
+        {
+            return catalog_;
+        }
+
+    private:
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        const ConcurrentCatalog& holder_;
+        unsigned int slot_;
+        const Catalog* catalog_;
+    };
+
+    /**
+     * Apply a new element set drop and publish the result. Updates are
+     * serialised with respect to each other but do not block readers.
+     * @param[in] tles the complete new element set
+     * @returns the changes that were made
+     * @exception SatelliteException if an element set is invalid
+     */
+    CatalogUpdate Update(const std::vector<Tle>& tles);
+
+    /**
+     * Free superseded versions that are no longer visible to any reader.
+     * Called by Update, but may also be called periodically by the updater.
+     * @returns the number of versions still waiting to be freed
+     */
+    size_t Reclaim();
+
+private:
+    ConcurrentCatalog(const ConcurrentCatalog&) = delete;
+    ConcurrentCatalog& operator=(const ConcurrentCatalog&) = delete;
+
+    unsigned int AcquireSlot() const;
+    void ReleaseSlot(unsigned int slot) const;
+    size_t ReclaimRetired();
+
+    /*
+     * a readers epoch, or zero if the slot is free. padded so that
+     * readers do not share cache lines
+     */
+    struct ReaderSlot
+    {
+        std::atomic<uint64_t> epoch;
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    struct RetiredVersion
+    {
+        const Catalog* catalog;
+        /** readers with an epoch at least this cannot see catalog */
+        uint64_t epoch;
+    };
+
+    std::atomic<const Catalog*> current_;
+    std::atomic<uint64_t> global_epoch_;
+    ReaderSlot* slots_;
+    unsigned int num_slots_;
+
+    std::mutex update_mutex_;
+    std::vector<RetiredVersion> retired_;
+};
+
+#endif
@@ -0,0 +1,474 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "CoverageEngine.h"
+
+#include "Globals.h"
+#include "SiderealGrid.h"
+#include "StationFrame.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /*
+     * time samples worked on at once. each pass over the grid rows covers
+     * this many samples
+     */
+    static const size_t kStepsPerBlock = 128;
+
+    /*
+     * the footprint is worked out for a spherical earth of the polar radius.
+     * it is widened to cover the cell latitudes being geodetic and
+     * elevations being measured from the geodetic vertical, each of which is
+     * within 0.2 degrees of the spherical value
+     */
+    static const double kPolarRadius = kXKMPER * (1.0 - kF);
+    static const double kFootprintMargin = 0.5 * kPI / 180.0;
+
+    /*
+     * a satellite at one sample, in earth fixed axes
+     */
+    struct Footprint
+    {
+        double x;
+        double y;
+        double z;
+        /** geocentric latitude and longitude of the sub satellite point */
+        double latitude;
+        double sin_latitude;
+        double cos_latitude;
+        double longitude;
+        /** earth central angle of the footprint, negative if there is none */
+        double angle;
+        double cos_angle;
+    };
+
+    /*
+     * the satellites whose footprints reach each row at one sample
+     */
+    struct RowIndex
+    {
+        /** satellites for row r are offsets[r] to offsets[r + 1] - 1 */
+        std::vector<size_t> offsets;
+        std::vector<size_t> satellites;
+    };
+
+    /*
+     * find the rows whose centres lie within the footprint's latitudes
+     */
+    bool RowRange(const Footprint& footprint,
+            size_t rows,
+            size_t& first,
+            size_t& last)
+    {
+        if (footprint.angle < 0.0)
+        {
+            return false;
+        }
+
+        const double height = kPI / static_cast<double>(rows);
+        const double low = std::max(0.0, std::ceil(
+                    (footprint.latitude - footprint.angle + kPI / 2.0)
+                    / height - 0.5));
+        const double high = std::min(static_cast<double>(rows - 1),
+                std::floor((footprint.latitude + footprint.angle + kPI / 2.0)
+                    / height - 0.5));
+        if (low > high)
+        {
+            return false;
+        }
+
+        first = static_cast<size_t>(low);
+        last = static_cast<size_t>(high);
+        return true;
+    }
+
+    /*
+     * count a satellite as in view of the cells of one row from column
+     * first to last - 1 that it is above the minimum elevation of. the
+     * elevation test compares signed squares to save a square root, and the
+     * loop is over a plain run of columns so that it can be vectorised
+     */
+    void CountInView(const Footprint& footprint,
+            double radius,
+            double z,
+            double sin_lat,
+            double cos_lat,
+            const double* sin_lon,
+            const double* cos_lon,
+            double sin_min_elevation,
+            size_t first,
+            size_t last,
+            unsigned long* in_view)
+    {
+        const double limit = sin_min_elevation * fabs(sin_min_elevation);
+        const double dz = footprint.z - z;
+        for (size_t column = first; column < last; column++)
+        {
+            const double dx = footprint.x - radius * cos_lon[column];
+            const double dy = footprint.y - radius * sin_lon[column];
+            const double up = cos_lat
+                * (dx * cos_lon[column] + dy * sin_lon[column])
+                + sin_lat * dz;
+            const double range_squared = dx * dx + dy * dy + dz * dz;
+            in_view[column] += (up * fabs(up) >= limit * range_squared);
+        }
+    }
+
+    void BuildIndex(const Footprint* footprints,
+            size_t satellites,
+            size_t rows,
+            RowIndex& index)
+    {
+        std::vector<size_t> first(satellites);
+        std::vector<size_t> last(satellites);
+        std::vector<bool> used(satellites);
+
+        index.offsets.assign(rows + 1, 0);
+        for (size_t i = 0; i < satellites; i++)
+        {
+            used[i] = RowRange(footprints[i], rows, first[i], last[i]);
+            if (used[i])
+            {
+                for (size_t row = first[i]; row <= last[i]; row++)
+                {
+                    index.offsets[row + 1]++;
+                }
+            }
+        }
+
+        for (size_t row = 0; row < rows; row++)
+        {
+            index.offsets[row + 1] += index.offsets[row];
+        }
+
+        std::vector<size_t> fill(index.offsets.begin(),
+                index.offsets.end() - 1);
+        index.satellites.resize(index.offsets[rows]);
+        for (size_t i = 0; i < satellites; i++)
+        {
+            if (used[i])
+            {
+                for (size_t row = first[i]; row <= last[i]; row++)
+                {
+                    index.satellites[fill[row]++] = i;
+                }
+            }
+        }
+    }
+}
+
+double CoverageGrid::Latitude(size_t row) const
+{
+    return (static_cast<double>(row) + 0.5) * kPI
+        / static_cast<double>(rows_) - kPI / 2.0;
+}
+
+double CoverageGrid::Longitude(size_t column) const
+{
+    return (static_cast<double>(column) + 0.5) * kTWOPI
+        / static_cast<double>(columns_) - kPI;
+}
+
+CoverageGrid CoverageEngine::Evaluate(
+        const std::vector<SGP4>& satellites,
+        size_t rows,
+        size_t columns,
+        const DateTime& start_time,
+        const DateTime& end_time) const
+{
+    if (rows == 0 || columns == 0)
+    {
+        throw std::invalid_argument("Coverage grid needs rows and columns");
+    }
+
+    CoverageGrid grid(rows, columns, time_step_);
+
+    /*
+     * cell centres. the position and vertical of a cell split into a part
+     * from its row and a part from its column
+     */
+    std::vector<double> row_radius(rows);
+    std::vector<double> row_z(rows);
+    std::vector<double> sin_lat(rows);
+    std::vector<double> cos_lat(rows);
+    for (size_t row = 0; row < rows; row++)
+    {
+        const StationFrame frame(
+                CoordGeodetic(grid.Latitude(row), 0.0, 0.0, true));
+        row_radius[row] = frame.Position().x;
+        row_z[row] = frame.Position().z;
+        sin_lat[row] = frame.SinLatitude();
+        cos_lat[row] = frame.CosLatitude();
+    }
+
+    std::vector<double> sin_lon(columns);
+    std::vector<double> cos_lon(columns);
+    for (size_t column = 0; column < columns; column++)
+    {
+        sin_lon[column] = sin(grid.Longitude(column));
+        cos_lon[column] = cos(grid.Longitude(column));
+    }
+
+    const double sin_min_elevation = sin(min_elevation_);
+    const double cos_min_elevation = cos(min_elevation_);
+    const double column_width = kTWOPI / static_cast<double>(columns);
+    const long column_count = static_cast<long>(columns);
+
+    /*
+     * sample number plus one of the last sample each cell was covered at,
+     * zero if never
+     */
+    std::vector<unsigned long> last_covered(rows * columns, 0);
+
+    const size_t count = satellites.size();
+    std::vector<Footprint> footprints(kStepsPerBlock * count);
+    std::vector<RowIndex> indices(kStepsPerBlock);
+
+    /*
+     * each satellite carries its integrator from one block to the next
+     */
+    std::vector<SGP4::IntegratorParams> integrators(count);
+    std::vector<char> failed(count, 0);
+
+    WorkStealingPool pool(thread_count_);
+    SiderealGrid sidereal;
+    unsigned long step = 0;
+    while (SiderealGrid::TimeOf(start_time, time_step_, step) < end_time)
+    {
+        size_t steps = 0;
+        while (steps < kStepsPerBlock
+                && SiderealGrid::TimeOf(start_time, time_step_, step + steps)
+                < end_time)
+        {
+            steps++;
+        }
+        sidereal.Fill(start_time, time_step_, step, steps);
+
+        /*
+         * propagate each satellite over the block and find its footprints
+         */
+        pool.Run(count, [&](size_t satellite)
+                {
+                    for (size_t s = 0; s < steps; s++)
+                    {
+                        const unsigned long point = step + s;
+                        Footprint& footprint =
+                            footprints[s * count + satellite];
+
+                        /*
+                         * a satellite that fails to propagate, for
+                         * example because it decayed, covers nothing from
+                         * then on
+                         */
+                        Vector position;
+                        try
+                        {
+                            if (!failed[satellite])
+                            {
+                                position = satellites[satellite].FindPosition(
+                                        SiderealGrid::TimeOf(start_time,
+                                            time_step_, point),
+                                        integrators[satellite]).Position();
+                            }
+                        }
+                        catch (SatelliteException&)
+                        {
+                            failed[satellite] = 1;
+                        }
+                        catch (DecayedException&)
+                        {
+                            failed[satellite] = 1;
+                        }
+                        if (failed[satellite])
+                        {
+                            footprint.angle = -1.0;
+                            continue;
+                        }
+
+                        const double sin_gmst = sidereal.Sin(point);
+                        const double cos_gmst = sidereal.Cos(point);
+
+                        const Vector fixed = StationFrame::ToEarthFixed(
+                                position, sin_gmst, cos_gmst);
+                        footprint.x = fixed.x;
+                        footprint.y = fixed.y;
+                        footprint.z = fixed.z;
+
+                        const double axis = sqrt(footprint.x * footprint.x
+                                + footprint.y * footprint.y);
+                        const double radius = sqrt(axis * axis
+                                + footprint.z * footprint.z);
+                        footprint.latitude = atan2(footprint.z, axis);
+                        footprint.sin_latitude = footprint.z / radius;
+                        footprint.cos_latitude = axis / radius;
+                        footprint.longitude = atan2(footprint.y, footprint.x);
+
+                        const double ratio =
+                            kPolarRadius * cos_min_elevation / radius;
+                        if (ratio >= 1.0)
+                        {
+                            footprint.angle = -1.0;
+                        }
+                        else
+                        {
+                            footprint.angle = std::min(kPI, acos(ratio)
+                                    - min_elevation_ + kFootprintMargin);
+                        }
+                        footprint.cos_angle = cos(footprint.angle);
+                    }
+                });
+
+        pool.Run(steps, [&](size_t s)
+                {
+                    BuildIndex(&footprints[s * count], count, rows,
+                            indices[s]);
+                });
+
+        /*
+         * each row gathers the satellites in view of its cells at every
+         * sample of the block, then updates their statistics in time order
+         */
+        pool.Run(rows, [&](size_t row)
+                {
+                    std::vector<unsigned long> in_view(columns);
+
+                    for (size_t s = 0; s < steps; s++)
+                    {
+                        std::fill(in_view.begin(), in_view.end(), 0);
+
+                        const RowIndex& index = indices[s];
+                        for (size_t k = index.offsets[row];
+                                k < index.offsets[row + 1]; k++)
+                        {
+                            const Footprint& footprint =
+                                footprints[s * count + index.satellites[k]];
+
+                            /*
+                             * longitudes either side of the sub satellite
+                             * point the footprint reaches along this row
+                             */
+                            double half_width = kPI;
+                            const double denominator =
+                                cos_lat[row] * footprint.cos_latitude;
+                            if (denominator > 1.0e-12)
+                            {
+                                const double q = (footprint.cos_angle
+                                        - sin_lat[row]
+                                        * footprint.sin_latitude)
+                                    / denominator;
+                                if (q >= 1.0)
+                                {
+                                    continue;
+                                }
+                                if (q > -1.0)
+                                {
+                                    half_width = acos(q);
+                                }
+                            }
+
+                            long first = static_cast<long>(std::ceil(
+                                        (footprint.longitude - half_width
+                                         + kPI) / column_width - 0.5));
+                            long last = static_cast<long>(std::floor(
+                                        (footprint.longitude + half_width
+                                         + kPI) / column_width - 0.5));
+                            if (half_width >= kPI
+                                    || last - first + 1 >= column_count)
+                            {
+                                first = 0;
+                                last = column_count - 1;
+                            }
+                            if (last < first)
+                            {
+                                continue;
+                            }
+
+                            /*
+                             * the run of columns may wrap past 180 degrees
+                             */
+                            const long begin = (first % column_count
+                                    + column_count) % column_count;
+                            const long end = begin + last - first + 1;
+                            CountInView(footprint, row_radius[row],
+                                    row_z[row], sin_lat[row], cos_lat[row],
+                                    &sin_lon[0], &cos_lon[0],
+                                    sin_min_elevation,
+                                    static_cast<size_t>(begin),
+                                    static_cast<size_t>(
+                                        std::min(end, column_count)),
+                                    &in_view[0]);
+                            if (end > column_count)
+                            {
+                                CountInView(footprint, row_radius[row],
+                                        row_z[row], sin_lat[row],
+                                        cos_lat[row], &sin_lon[0],
+                                        &cos_lon[0], sin_min_elevation, 0,
+                                        static_cast<size_t>(
+                                            end - column_count),
+                                        &in_view[0]);
+                            }
+                        }
+
+                        const unsigned long sample = step + s;
+                        for (size_t column = 0; column < columns; column++)
+                        {
+                            if (in_view[column] == 0)
+                            {
+                                continue;
+                            }
+
+                            const size_t i = row * columns + column;
+                            CoverageCell& cell = grid.cells_[i];
+                            cell.covered++;
+                            cell.in_view += in_view[column];
+                            if (last_covered[i] != sample)
+                            {
+                                cell.accesses++;
+                                if (last_covered[i] != 0)
+                                {
+                                    const double gap = time_step_
+                                        * static_cast<double>(
+                                                sample + 1 - last_covered[i]);
+                                    cell.gaps++;
+                                    cell.total_gap += gap;
+                                    cell.max_gap = std::max(cell.max_gap, gap);
+                                }
+                            }
+                            last_covered[i] = sample + 1;
+                        }
+                    }
+                });
+
+        step += steps;
+    }
+
+    grid.samples_ = step;
+    for (size_t satellite = 0; satellite < count; satellite++)
+    {
+        if (failed[satellite])
+        {
+            grid.failed_.push_back(satellite);
+        }
+    }
+
+    return grid;
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef COVERAGEENGINE_H_
+#define COVERAGEENGINE_H_
+
+#include "DateTime.h"
+#include "SGP4.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Coverage counters for one grid cell.
+ *
+ * An access is a run of samples during which at least one satellite is in
+ * view. A revisit gap is the time from the last sample of one access to the
+ * first sample of the next, so time before the first access and after the
+ * last is not counted as a gap.
+ */
+struct CoverageCell
+{
+    CoverageCell()
+        : covered(0)
+        , accesses(0)
+        , gaps(0)
+        , max_gap(0.0)
+        , total_gap(0.0)
+        , in_view(0)
+    {
+    }
+
+    /** samples with at least one satellite in view */
+    unsigned long covered;
+    /** number of accesses */
+    unsigned long accesses;
+    /** number of revisit gaps */
+    unsigned long gaps;
+    /** longest revisit gap in seconds */
+    double max_gap;
+    /** sum of the revisit gaps in seconds */
+    double total_gap;
+    /** satellites in view, summed over every sample */
+    unsigned long in_view;
+};
+
+/**
+ * @brief Coverage statistics over a global latitude and longitude grid.
+ *
+ * The grid divides latitude into rows of equal height from the south pole
+ * and longitude into columns of equal width from -180 degrees. Each cell is
+ * represented by the point at its centre, at zero altitude.
+ */
+class CoverageGrid
+{
+public:
+    /**
+     * Constructor
+     * @param[in] rows the number of latitude rows
+     * @param[in] columns the number of longitude columns
+     * @param[in] time_step the time between samples in seconds
+     */
+    CoverageGrid(size_t rows, size_t columns, double time_step)
+        : rows_(rows)
+        , columns_(columns)
+        , time_step_(time_step)
+        , samples_(0)
+        , cells_(rows * columns)
+    {
+    }
+
+    size_t Rows() const
+    {
+        return rows_;
+    }
+
+    size_t Columns() const
+    {
+        return columns_;
+    }
+
+    /**
+     * @returns the time between samples in seconds
+     */
+    double TimeStep() const
+    {
+        return time_step_;
+    }
+
+    /**
+     * @returns the number of time samples taken
+     */
+    unsigned long Samples() const
+    {
+        return samples_;
+    }
+
+    /**
+     * @param[in] row the row
+     * @returns the latitude of the centre of the row in radians
+     */
+    double Latitude(size_t row) const;
+
+    /**
+     * @param[in] column the column
+     * @returns the longitude of the centre of the column in radians
+     */
+    double Longitude(size_t column) const;
+
+    /**
+     * @param[in] row the row
+     * @param[in] column the column
+     * @returns the counters for the cell
+     */
+    const CoverageCell& Cell(size_t row, size_t column) const
+    {
+        return cells_[row * columns_ + column];
+    }
+
+    /**
+     * @param[in] row the row
+     * @param[in] column the column
+     * @returns the percentage of samples with a satellite in view
+     */
+    double PercentCoverage(size_t row, size_t column) const
+    {
+        if (samples_ == 0)
+        {
+            return 0.0;
+        }
+        return 100.0 * static_cast<double>(Cell(row, column).covered)
+            / static_cast<double>(samples_);
+    }
+
+    /**
+     * @param[in] row the row
+     * @param[in] column the column
+     * @returns the mean revisit gap in seconds, or zero without any gaps
+     */
+    double MeanGap(size_t row, size_t column) const
+    {
+        const CoverageCell& cell = Cell(row, column);
+        if (cell.gaps == 0)
+        {
+            return 0.0;
+        }
+        return cell.total_gap / static_cast<double>(cell.gaps);
+    }
+
+    /**
+     * @returns the indices of satellites which failed to propagate, in
+     *          ascending order. each counts towards coverage only up to the
+     *          sample at which it failed
+     */
+    const std::vector<size_t>& Failed() const
+    {
+        return failed_;
+    }
+
+private:
+    friend class CoverageEngine;
+
+    size_t rows_;
+    size_t columns_;
+    double time_step_;
+    unsigned long samples_;
+    std::vector<CoverageCell> cells_;
+    std::vector<size_t> failed_;
+};
+
+/**
+ * @brief Works out the coverage of a set of satellites over a global grid.
+ *
+ * Time is sampled at a fixed step. At each sample every satellite is
+ * propagated once, and its footprint, the cap of the earth from which it is
+ * above the minimum elevation, is worked out from its altitude. The grid
+ * rows are indexed by which footprints reach their latitude, and within a
+ * row only the run of columns under a footprint is looked at. Cells found
+ * this way are checked exactly, so a satellite is in view of a cell when
+ * Observer::GetLookAngle would give at least the minimum elevation from the
+ * cell centre. Propagation is split across satellites and the statistics
+ * across rows, on a WorkStealingPool. Results do not depend on the number
+ * of threads. A satellite which fails to propagate drops out from the
+ * sample at which it fails and is listed in CoverageGrid::Failed.
+ */
+class CoverageEngine
+{
+public:
+    CoverageEngine()
+        : min_elevation_(0.0)
+        , time_step_(60.0)
+        , thread_count_(0)
+    {
+    }
+
+    /**
+     * Set the number of threads to work on
+     * @param[in] thread_count the number of threads, or zero for the number
+     *            of hardware threads
+     */
+    void SetThreadCount(unsigned int thread_count)
+    {
+        thread_count_ = thread_count;
+    }
+
+    /**
+     * Set the elevation a satellite must be above to cover a cell
+     * @param[in] elevation the minimum elevation in radians
+     */
+    void SetMinElevation(double elevation)
+    {
+        min_elevation_ = elevation;
+    }
+
+    /**
+     * Set the time between samples. Accesses shorter than this may be
+     * missed, and access and gap lengths are whole numbers of steps.
+     * @param[in] seconds the time step in seconds
+     */
+    void SetTimeStep(double seconds)
+    {
+        time_step_ = seconds;
+    }
+
+    /**
+     * Work out the coverage of the satellites, sampling from the start time
+     * up to but not including the end time
+     * @param[in] satellites the satellites
+     * @param[in] rows the number of latitude rows
+     * @param[in] columns the number of longitude columns
+     * @param[in] start_time the start of the period
+     * @param[in] end_time the end of the period
+     * @returns the coverage of every cell
+     * @exception std::invalid_argument if the grid has no cells
+     */
+    CoverageGrid Evaluate(const std::vector<SGP4>& satellites,
+            size_t rows,
+            size_t columns,
+            const DateTime& start_time,
+            const DateTime& end_time) const;
+
+private:
+    double min_elevation_;
+    double time_step_;
+    unsigned int thread_count_;
+};
+
+#endif
@@ -18,67 +18,42 @@
 #include "Eci.h"
 
 #include "Globals.h"
+#include "StationFrame.h"
 #include "Util.h"
 
 /**
  * Converts a DateTime and Geodetic position to Eci coordinates
  * @param[in] dt the date
  * @param[in] geo the geodetic position
+ * @param[in] gmst the greenwich mean sidereal time of dt
  */
-void Eci::ToEci(const DateTime& dt, const CoordGeodetic &geo)
+void Eci::ToEci(const DateTime& dt, const CoordGeodetic &geo, double gmst)
 {
     /*
      * set date
      */
     m_dt = dt;
 
-    static const double mfactor = kTWOPI * (kOMEGA_E / kSECONDS_PER_DAY);
-
-    /*
-     * Calculate Local Mean Sidereal Time for observers longitude
-     */
-    const double theta = m_dt.ToLocalMeanSiderealTime(geo.longitude);
-
-    /*
-     * take into account earth flattening
-     */
-    const double c = 1.0
-        / sqrt(1.0 + kF * (kF - 2.0) * pow(sin(geo.latitude), 2.0));
-    const double s = pow(1.0 - kF, 2.0) * c;
-    const double achcp = (kXKMPER * c + geo.altitude) * cos(geo.latitude);
-
-    /*
-     * X position in km
-     * Y position in km
-     * Z position in km
-     * W magnitude in km
-     */
-    m_position.x = achcp * cos(theta);
-    m_position.y = achcp * sin(theta);
-    m_position.z = (kXKMPER * s + geo.altitude) * sin(geo.latitude);
-    m_position.w = m_position.Magnitude();
-
-    /*
-     * X velocity in km/s
-     * Y velocity in km/s
-     * Z velocity in km/s
-     * W magnitude in km/s
-     */
-    m_velocity.x = -mfactor * m_position.y;
-    m_velocity.y = mfactor * m_position.x;
-    m_velocity.z = 0.0;
-    m_velocity.w = m_velocity.Magnitude();
+    StationFrame(geo).ToEci(sin(gmst), cos(gmst), m_position, m_velocity);
 }
 
 /**
  * @returns the position in geodetic form
  */
 CoordGeodetic Eci::ToGeodetic() const
+{
+    return ToGeodetic(m_dt.ToGreenwichSiderealTime());
+}
+
+/**
+ * @param[in] gmst the greenwich mean sidereal time of the position
+ * @returns the position in geodetic form
+ */
+CoordGeodetic Eci::ToGeodetic(double gmst) const
 {
     const double theta = Util::AcTan(m_position.y, m_position.x);
 
-    const double lon = Util::WrapNegPosPI(theta
-            - m_dt.ToGreenwichSiderealTime());
+    const double lon = Util::WrapNegPosPI(theta - gmst);
 
     const double r = sqrt((m_position.x * m_position.x)
             + (m_position.y * m_position.y));
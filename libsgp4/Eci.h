@@ -40,7 +40,8 @@ public:
             const double longitude,
             const double altitude)
     {
-        ToEci(dt, CoordGeodetic(latitude, longitude, altitude));
+        ToEci(dt, CoordGeodetic(latitude, longitude, altitude),
+                dt.ToGreenwichSiderealTime());
     }
 
     /**
@@ -49,7 +50,17 @@ public:
      */
     Eci(const DateTime& dt, const CoordGeodetic& geo)
     {
-        ToEci(dt, geo);
+        ToEci(dt, geo, dt.ToGreenwichSiderealTime());
+    }
+
+    /**
+     * @param[in] dt the date to be used for this position
+     * @param[in] geo the position
+     * @param[in] gmst the greenwich mean sidereal time of dt in radians
+     */
+    Eci(const DateTime& dt, const CoordGeodetic& geo, double gmst)
+    {
+        ToEci(dt, geo, gmst);
     }
 
     /**
@@ -101,7 +112,7 @@ public:
      */
     void Update(const DateTime& dt, const CoordGeodetic& geo)
     {
-        ToEci(dt, geo);
+        ToEci(dt, geo, dt.ToGreenwichSiderealTime());
     }
 
     /**
@@ -133,8 +144,15 @@ public:
      */
     CoordGeodetic ToGeodetic() const;
 
+    /**
+     * @param[in] gmst the greenwich mean sidereal time of the position in
+     *            radians
+     * @returns the position in geodetic form
+     */
+    CoordGeodetic ToGeodetic(double gmst) const;
+
 private:
-    void ToEci(const DateTime& dt, const CoordGeodetic& geo);
+    void ToEci(const DateTime& dt, const CoordGeodetic& geo, double gmst);
 
     DateTime m_dt;
     Vector m_position;
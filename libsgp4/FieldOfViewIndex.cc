@@ -0,0 +1,381 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "FieldOfViewIndex.h"
+
+#include "DecayedException.h"
+#include "Globals.h"
+#include "SatelliteException.h"
+#include "StationFrame.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /*
+     * height of an elevation band, and the rough width of an azimuth bin
+     */
+    static const double kBandHeight = 2.0 * kPI / 180.0;
+
+    static const size_t kObjectsPerTask = 256;
+
+    /*
+     * more than the acceleration of anything in orbit relative to a station,
+     * in kilometres per second squared
+     */
+    static const double kMaxAcceleration = 0.01;
+
+    static const double kEarthRate = kTWOPI * kOMEGA_E / kSECONDS_PER_DAY;
+
+    /*
+     * the widest angle the direction of an object from the station can turn
+     * through in a time. the object moves at most its relative speed times
+     * the time, plus the distance the largest acceleration adds, which turns
+     * the inertial direction by at most the asin of that distance over the
+     * range. the stations axes turn with the earth on top of that
+     */
+    double SweepAngle(double rate, double inverse_range, double seconds)
+    {
+        const double ratio = rate * seconds
+            + inverse_range * 0.5 * kMaxAcceleration * seconds * seconds;
+        if (ratio >= 1.0)
+        {
+            return kPI;
+        }
+        return asin(ratio) + kEarthRate * seconds;
+    }
+
+    /*
+     * cosine of the angle between a look angle and a direction given by its
+     * east, north and up parts
+     */
+    double CosSeparation(const CoordTopocentric& look,
+            double east,
+            double north,
+            double up)
+    {
+        const double cos_el = cos(look.elevation);
+        return cos_el * sin(look.azimuth) * east
+            + cos_el * cos(look.azimuth) * north
+            + sin(look.elevation) * up;
+    }
+}
+
+FieldOfViewIndex::FieldOfViewIndex(
+        const std::vector<SGP4>& catalog,
+        const CoordGeodetic& station)
+    : catalog_(catalog)
+    , observer_(station)
+    , thread_count_(0)
+    , time_step_(60.0)
+    , built_(false)
+{
+    /*
+     * split each band into bins about as wide as the band is high, measured
+     * across the sky
+     */
+    const size_t bands = static_cast<size_t>(ceil(kPI / kBandHeight));
+    band_first_.push_back(0);
+    for (size_t band = 0; band < bands; band++)
+    {
+        const double centre = -kPI / 2.0
+            + (static_cast<double>(band) + 0.5) * kBandHeight;
+        const size_t bins = std::max<size_t>(1, static_cast<size_t>(
+                    ceil(kTWOPI * cos(centre) / kBandHeight)));
+        band_first_.push_back(band_first_.back() + bins);
+    }
+}
+
+/*
+ * a step which is not positive would rebuild the snapshot, a pass over the
+ * whole catalog, at every query
+ */
+void FieldOfViewIndex::SetTimeStep(double seconds)
+{
+    if (!(seconds > 0.0))
+    {
+        throw std::invalid_argument("Time step must be positive");
+    }
+    time_step_ = seconds;
+}
+
+size_t FieldOfViewIndex::BandOf(double elevation) const
+{
+    const double band = floor((elevation + kPI / 2.0) / kBandHeight);
+    const size_t bands = band_first_.size() - 1;
+    if (band < 0.0)
+    {
+        return 0;
+    }
+    return std::min(bands - 1, static_cast<size_t>(band));
+}
+
+void FieldOfViewIndex::Update(const DateTime& dt)
+{
+    snapshot_time_ = dt;
+    built_ = true;
+
+    const double gmst = dt.ToGreenwichSiderealTime();
+    const StationFrame frame(observer_.GetLocation());
+    Vector station_position;
+    Vector station_velocity;
+    frame.ToEci(sin(gmst), cos(gmst), station_position, station_velocity);
+
+    const size_t count = catalog_.size();
+    /*
+     * char rather than bool, as tasks write neighbouring elements at once
+     */
+    std::vector<char> valid(count, 0);
+    std::vector<CoordTopocentric> look_angles(count);
+    std::vector<double> rates(count);
+
+    WorkStealingPool pool(thread_count_);
+    pool.Run((count + kObjectsPerTask - 1) / kObjectsPerTask,
+            [&](size_t task)
+            {
+                const size_t first = task * kObjectsPerTask;
+                const size_t last = std::min(first + kObjectsPerTask, count);
+                for (size_t i = first; i < last; i++)
+                {
+                    try
+                    {
+                        const Eci eci = catalog_[i].FindPosition(dt);
+                        look_angles[i] = observer_.GetLookAngle(eci, gmst);
+                        const Vector velocity =
+                            eci.Velocity() - station_velocity;
+                        rates[i] = velocity.Magnitude()
+                            / look_angles[i].range;
+                        valid[i] = 1;
+                    }
+                    catch (const SatelliteException&)
+                    {
+                    }
+                    catch (const DecayedException&)
+                    {
+                    }
+                }
+            });
+
+    /*
+     * sort the objects into bins. objects which failed are kept aside, as
+     * they may still propagate at a query time
+     */
+    unplaced_.clear();
+    const size_t bands = band_first_.size() - 1;
+    std::vector<size_t> bins(count);
+    bin_offsets_.assign(band_first_.back() + 1, 0);
+    band_rate_.assign(bands, 0.0);
+    band_inverse_range_.assign(bands, 0.0);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!valid[i])
+        {
+            unplaced_.push_back(i);
+            continue;
+        }
+
+        const size_t band = BandOf(look_angles[i].elevation);
+        const size_t band_bins = band_first_[band + 1] - band_first_[band];
+        const size_t bin = std::min(band_bins - 1, static_cast<size_t>(
+                    look_angles[i].azimuth / kTWOPI
+                    * static_cast<double>(band_bins)));
+        bins[i] = band_first_[band] + bin;
+        bin_offsets_[bins[i] + 1]++;
+
+        band_rate_[band] = std::max(band_rate_[band], rates[i]);
+        band_inverse_range_[band] = std::max(band_inverse_range_[band],
+                1.0 / look_angles[i].range);
+    }
+
+    for (size_t bin = 0; bin + 1 < bin_offsets_.size(); bin++)
+    {
+        bin_offsets_[bin + 1] += bin_offsets_[bin];
+    }
+
+    const size_t entries = bin_offsets_.back();
+    objects_.resize(entries);
+    look_angles_.resize(entries);
+    east_.resize(entries);
+    north_.resize(entries);
+    up_.resize(entries);
+    rate_.resize(entries);
+    inverse_range_.resize(entries);
+
+    std::vector<size_t> fill(bin_offsets_.begin(), bin_offsets_.end() - 1);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!valid[i])
+        {
+            continue;
+        }
+
+        const size_t j = fill[bins[i]]++;
+        const CoordTopocentric& look = look_angles[i];
+        const double cos_el = cos(look.elevation);
+        objects_[j] = i;
+        look_angles_[j] = look;
+        east_[j] = cos_el * sin(look.azimuth);
+        north_[j] = cos_el * cos(look.azimuth);
+        up_[j] = sin(look.elevation);
+        rate_[j] = rates[i];
+        inverse_range_[j] = 1.0 / look.range;
+    }
+}
+
+std::vector<FieldOfViewHit> FieldOfViewIndex::Query(
+        const DateTime& dt,
+        double azimuth,
+        double elevation,
+        double half_angle)
+{
+    if (!built_
+            || fabs((dt - snapshot_time_).TotalSeconds()) > time_step_ / 2.0)
+    {
+        Update(dt.AddSeconds(time_step_ / 2.0));
+    }
+
+    const double seconds = fabs((dt - snapshot_time_).TotalSeconds());
+    const double cos_el = cos(elevation);
+    const double axis_east = cos_el * sin(azimuth);
+    const double axis_north = cos_el * cos(azimuth);
+    const double axis_up = sin(elevation);
+    const double cos_half_angle = cos(half_angle);
+
+    std::vector<FieldOfViewHit> hits;
+
+    /*
+     * propagate an object to the query time and keep it if it is inside
+     * the cone
+     */
+    auto check = [&](size_t object)
+    {
+        FieldOfViewHit hit;
+        hit.object = object;
+        try
+        {
+            hit.look_angle = observer_.GetLookAngle(
+                    catalog_[object].FindPosition(dt));
+        }
+        catch (const SatelliteException&)
+        {
+            return;
+        }
+        catch (const DecayedException&)
+        {
+            return;
+        }
+
+        if (CosSeparation(hit.look_angle, axis_east, axis_north, axis_up)
+                >= cos_half_angle)
+        {
+            hits.push_back(hit);
+        }
+    };
+
+    const size_t bands = band_first_.size() - 1;
+    for (size_t band = 0; band < bands; band++)
+    {
+        /*
+         * widen the cone by the furthest anything in the band can have
+         * moved since the snapshot
+         */
+        const double widened = half_angle + SweepAngle(band_rate_[band],
+                band_inverse_range_[band], seconds);
+        const double low = -kPI / 2.0
+            + static_cast<double>(band) * kBandHeight;
+        if (low + kBandHeight < elevation - widened
+                || low > elevation + widened)
+        {
+            continue;
+        }
+
+        /*
+         * unless it covers the zenith or nadir, the cone spans
+         * asin(sin(widened) / cos(elevation)) either side in azimuth
+         */
+        const long band_bins =
+            static_cast<long>(band_first_[band + 1] - band_first_[band]);
+        const double bin_width = kTWOPI / static_cast<double>(band_bins);
+        long first = 0;
+        long last = band_bins - 1;
+        if (fabs(elevation) + widened < kPI / 2.0)
+        {
+            const double half_width = asin(sin(widened) / cos_el);
+            first = static_cast<long>(floor(
+                        (azimuth - half_width) / bin_width));
+            last = static_cast<long>(floor(
+                        (azimuth + half_width) / bin_width));
+            if (last - first + 1 >= band_bins)
+            {
+                first = 0;
+                last = band_bins - 1;
+            }
+        }
+
+        for (long k = first; k <= last; k++)
+        {
+            const size_t bin = band_first_[band]
+                + static_cast<size_t>((k % band_bins + band_bins) % band_bins);
+            for (size_t j = bin_offsets_[bin]; j < bin_offsets_[bin + 1]; j++)
+            {
+                const double limit = half_angle
+                    + SweepAngle(rate_[j], inverse_range_[j], seconds);
+                if (limit < kPI && east_[j] * axis_east
+                        + north_[j] * axis_north
+                        + up_[j] * axis_up < cos(limit))
+                {
+                    continue;
+                }
+
+                /*
+                 * at the snapshot time the held look angles are exact
+                 */
+                if (seconds == 0.0)
+                {
+                    if (CosSeparation(look_angles_[j], axis_east,
+                                axis_north, axis_up) >= cos_half_angle)
+                    {
+                        FieldOfViewHit hit;
+                        hit.object = objects_[j];
+                        hit.look_angle = look_angles_[j];
+                        hits.push_back(hit);
+                    }
+                }
+                else
+                {
+                    check(objects_[j]);
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < unplaced_.size(); i++)
+    {
+        check(unplaced_[i]);
+    }
+
+    std::sort(hits.begin(), hits.end(),
+            [](const FieldOfViewHit& a, const FieldOfViewHit& b)
+            {
+                return a.object < b.object;
+            });
+
+    return hits;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FIELDOFVIEWINDEX_H_
+#define FIELDOFVIEWINDEX_H_
+
+#include "CoordGeodetic.h"
+#include "CoordTopocentric.h"
+#include "DateTime.h"
+#include "Observer.h"
+#include "SGP4.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief A catalog object found inside a field of view.
+ */
+struct FieldOfViewHit
+{
+    /** index of the object in the catalog */
+    size_t object;
+    /** look angle from the station at the query time */
+    CoordTopocentric look_angle;
+};
+
+/**
+ * @brief Finds the catalog objects inside a pointing cone from a station.
+ *
+ * The catalog is propagated to a snapshot time, and the directions of the
+ * objects from the station are binned into elevation bands, each split
+ * into azimuth bins of about the same size. A query looks only at the bins
+ * its cone reaches, widened by the furthest any object could have moved
+ * across the sky between the snapshot and the query time. The objects
+ * found are then propagated to the query time and checked exactly, so the
+ * results match Observer::GetLookAngle.
+ *
+ * A query more than half the time step from the snapshot time rebuilds the
+ * snapshot half a step after the query time, so queries made in time order
+ * share each snapshot for a whole step. Objects which fail to propagate to
+ * the snapshot time are checked at every query, and left out of the
+ * results of queries at times they fail to propagate to.
+ */
+class FieldOfViewIndex
+{
+public:
+    /**
+     * Constructor
+     * @param[in] catalog the objects
+     * @param[in] station the stations position
+     */
+    FieldOfViewIndex(const std::vector<SGP4>& catalog,
+            const CoordGeodetic& station);
+
+    /**
+     * Set the number of threads snapshots are propagated on
+     * @param[in] thread_count the number of threads, or zero for the number
+     *            of hardware threads
+     */
+    void SetThreadCount(unsigned int thread_count)
+    {
+        thread_count_ = thread_count;
+    }
+
+    /**
+     * Set the time between snapshots. A shorter step means more snapshots,
+     * but fewer objects to propagate for each query.
+     * @param[in] seconds the time step in seconds
+     * @exception std::invalid_argument if the step is not positive
+     */
+    void SetTimeStep(double seconds);
+
+    /**
+     * Propagate the catalog and rebuild the index
+     * @param[in] dt the snapshot time
+     */
+    void Update(const DateTime& dt);
+
+    /**
+     * @returns the time of the current snapshot
+     */
+    const DateTime& SnapshotTime() const
+    {
+        return snapshot_time_;
+    }
+
+    /**
+     * Find the objects inside a cone. The snapshot is rebuilt if the time is
+     * too far from it.
+     * @param[in] dt the time
+     * @param[in] azimuth the azimuth of the cone axis in radians
+     * @param[in] elevation the elevation of the cone axis in radians
+     * @param[in] half_angle the half angle of the cone in radians
+     * @returns the objects inside the cone, in catalog order
+     */
+    std::vector<FieldOfViewHit> Query(const DateTime& dt,
+            double azimuth,
+            double elevation,
+            double half_angle);
+
+private:
+    size_t BandOf(double elevation) const;
+
+    std::vector<SGP4> catalog_;
+    Observer observer_;
+    unsigned int thread_count_;
+    double time_step_;
+    bool built_;
+    DateTime snapshot_time_;
+
+    /** first bin of each band, with the total bin count at the end */
+    std::vector<size_t> band_first_;
+    /** fastest relative speed over range of any object in each band */
+    std::vector<double> band_rate_;
+    /** largest inverse range of any object in each band */
+    std::vector<double> band_inverse_range_;
+    /** first entry of each bin, with the entry count at the end */
+    std::vector<size_t> bin_offsets_;
+
+    /*
+     * objects ordered by bin
+     */
+    std::vector<size_t> objects_;
+    std::vector<CoordTopocentric> look_angles_;
+    /** unit directions in east, north and up axes */
+    std::vector<double> east_;
+    std::vector<double> north_;
+    std::vector<double> up_;
+    /** relative speed divided by range, per second */
+    std::vector<double> rate_;
+    /** one over the range, per kilometre */
+    std::vector<double> inverse_range_;
+
+    /** objects which failed to propagate to the snapshot time */
+    std::vector<size_t> unplaced_;
+};
+
+#endif
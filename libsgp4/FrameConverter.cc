@@ -0,0 +1,349 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "FrameConverter.h"
+
+#include "Globals.h"
+#include "StationFrame.h"
+#include "TimeSpan.h"
+#include "Util.h"
+
+#include <cmath>
+
+namespace
+{
+    static const double kArcSecond = kPI / (180.0 * 3600.0);
+
+    /*
+     * the celestial rotation is worked out at multiples of this many ticks
+     * and interpolated in between
+     */
+    static const int64_t kCelestialBlock = TicksPerHour;
+
+    /*
+     * IAU 1980 nutation terms above 0.002 arcseconds in longitude. the
+     * multipliers of l, l', F, D and omega, then the coefficients of the
+     * longitude and obliquity and their rates per century, in units of
+     * 0.0001 arcseconds
+     */
+    struct NutationTerm
+    {
+        int l;
+        int lp;
+        int f;
+        int d;
+        int om;
+        double psi;
+        double psi_t;
+        double eps;
+        double eps_t;
+    };
+
+    static const NutationTerm kNutation[] =
+    {
+        {  0,  0,  0,  0,  1, -171996.0, -174.2, 92025.0,  8.9 },
+        {  0,  0,  2, -2,  2,  -13187.0,   -1.6,  5736.0, -3.1 },
+        {  0,  0,  2,  0,  2,   -2274.0,   -0.2,   977.0, -0.5 },
+        {  0,  0,  0,  0,  2,    2062.0,    0.2,  -895.0,  0.5 },
+        {  0,  1,  0,  0,  0,    1426.0,   -3.4,    54.0, -0.1 },
+        {  1,  0,  0,  0,  0,     712.0,    0.1,    -7.0,  0.0 },
+        {  0,  1,  2, -2,  2,    -517.0,    1.2,   224.0, -0.6 },
+        {  0,  0,  2,  0,  1,    -386.0,   -0.4,   200.0,  0.0 },
+        {  1,  0,  2,  0,  2,    -301.0,    0.0,   129.0, -0.1 },
+        {  0, -1,  2, -2,  2,     217.0,   -0.5,   -95.0,  0.3 },
+        {  1,  0,  0, -2,  0,    -158.0,    0.0,    -1.0,  0.0 },
+        {  0,  0,  2, -2,  1,     129.0,    0.1,   -70.0,  0.0 },
+        { -1,  0,  2,  0,  2,     123.0,    0.0,   -53.0,  0.0 },
+        {  0,  0,  0,  2,  0,      63.0,    0.0,    -2.0,  0.0 },
+        {  1,  0,  0,  0,  1,      63.0,    0.1,   -33.0,  0.0 },
+        { -1,  0,  2,  2,  2,     -59.0,    0.0,    26.0,  0.0 },
+        { -1,  0,  0,  0,  1,     -58.0,   -0.1,    32.0,  0.0 },
+        {  1,  0,  2,  0,  1,     -51.0,    0.0,    27.0,  0.0 },
+        {  2,  0,  0, -2,  0,      48.0,    0.0,     1.0,  0.0 },
+        { -2,  0,  2,  0,  1,      46.0,    0.0,   -24.0,  0.0 },
+        {  0,  0,  2,  2,  2,     -38.0,    0.0,    16.0,  0.0 },
+        {  2,  0,  2,  0,  2,     -31.0,    0.0,    13.0,  0.0 },
+        {  2,  0,  0,  0,  0,      29.0,    0.0,    -1.0,  0.0 },
+        {  1,  0,  2, -2,  2,      29.0,    0.0,   -12.0,  0.0 },
+        {  0,  0,  2,  0,  0,      26.0,    0.0,    -1.0,  0.0 },
+        {  0,  0,  2, -2,  0,     -22.0,    0.0,     0.0,  0.0 },
+        { -1,  0,  2,  0,  1,      21.0,    0.0,   -10.0,  0.0 }
+    };
+
+    /*
+     * a rotation between frames, rows then columns
+     */
+    struct Rotation
+    {
+        double m[3][3];
+    };
+
+    /*
+     * rotations of the frame about the x, y and z axes
+     */
+    Rotation AboutX(double angle)
+    {
+        const double c = cos(angle);
+        const double s = sin(angle);
+        const Rotation r = {{ { 1.0, 0.0, 0.0 }, { 0.0, c, s }, { 0.0, -s, c } }};
+        return r;
+    }
+
+    Rotation AboutY(double angle)
+    {
+        const double c = cos(angle);
+        const double s = sin(angle);
+        const Rotation r = {{ { c, 0.0, -s }, { 0.0, 1.0, 0.0 }, { s, 0.0, c } }};
+        return r;
+    }
+
+    Rotation AboutZ(double angle)
+    {
+        const double c = cos(angle);
+        const double s = sin(angle);
+        const Rotation r = {{ { c, s, 0.0 }, { -s, c, 0.0 }, { 0.0, 0.0, 1.0 } }};
+        return r;
+    }
+
+    Rotation Multiply(const Rotation& a, const Rotation& b)
+    {
+        Rotation r;
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                r.m[i][j] = a.m[i][0] * b.m[0][j]
+                    + a.m[i][1] * b.m[1][j]
+                    + a.m[i][2] * b.m[2][j];
+            }
+        }
+        return r;
+    }
+
+    Vector Apply(const Rotation& r, const Vector& v)
+    {
+        return Vector(r.m[0][0] * v.x + r.m[0][1] * v.y + r.m[0][2] * v.z,
+                r.m[1][0] * v.x + r.m[1][1] * v.y + r.m[1][2] * v.z,
+                r.m[2][0] * v.x + r.m[2][1] * v.y + r.m[2][2] * v.z,
+                v.w);
+    }
+
+    /*
+     * rotation from the pseudo earth fixed frame to the earth fixed frame
+     */
+    Rotation PolarMotion(double xp, double yp)
+    {
+        return Multiply(AboutY(-xp), AboutX(-yp));
+    }
+
+    /*
+     * rotation from TEME to GCRF: the equation of the equinoxes takes TEME
+     * to true of date, nutation to mean of date and precession to J2000
+     */
+    Rotation CelestialRotation(const DateTime& dt)
+    {
+        const double t = (dt.ToJulian() - 2451545.0) / 36525.0;
+
+        /*
+         * IAU 1976 precession angles
+         */
+        const double zeta = ((0.017998 * t + 0.30188) * t + 2306.2181) * t
+            * kArcSecond;
+        const double theta = ((-0.041833 * t - 0.42665) * t + 2004.3109) * t
+            * kArcSecond;
+        const double z = ((0.018203 * t + 1.09468) * t + 2306.2181) * t
+            * kArcSecond;
+
+        /*
+         * IAU 1980 fundamental arguments and nutation
+         */
+        const double l = Util::DegreesToRadians(((0.064 * t + 31.310) * t
+                    + 1717915922.6330) * t / 3600.0 + 134.96298139);
+        const double lp = Util::DegreesToRadians(((-0.012 * t - 0.577) * t
+                    + 129596581.2240) * t / 3600.0 + 357.52772333);
+        const double f = Util::DegreesToRadians(((0.011 * t - 13.257) * t
+                    + 1739527263.1370) * t / 3600.0 + 93.27191028);
+        const double d = Util::DegreesToRadians(((0.019 * t - 6.891) * t
+                    + 1602961601.3280) * t / 3600.0 + 297.85036306);
+        const double om = Util::DegreesToRadians(((0.008 * t + 7.455) * t
+                    - 6962890.5390) * t / 3600.0 + 125.04452222);
+
+        double dpsi = 0.0;
+        double deps = 0.0;
+        for (size_t i = 0; i < sizeof(kNutation) / sizeof(kNutation[0]); i++)
+        {
+            const NutationTerm& term = kNutation[i];
+            const double arg = term.l * l + term.lp * lp + term.f * f
+                + term.d * d + term.om * om;
+            dpsi += (term.psi + term.psi_t * t) * sin(arg);
+            deps += (term.eps + term.eps_t * t) * cos(arg);
+        }
+        dpsi *= 0.0001 * kArcSecond;
+        deps *= 0.0001 * kArcSecond;
+
+        const double mean_eps = (((0.001813 * t - 0.00059) * t - 46.8150) * t
+                + 84381.448) * kArcSecond;
+        const double true_eps = mean_eps + deps;
+        const double eqe = dpsi * cos(mean_eps);
+
+        /*
+         * each step below is the transpose of the usual rotation from J2000
+         */
+        const Rotation precession = Multiply(AboutZ(zeta),
+                Multiply(AboutY(-theta), AboutZ(z)));
+        const Rotation nutation = Multiply(AboutX(-mean_eps),
+                Multiply(AboutZ(dpsi), AboutX(true_eps)));
+
+        return Multiply(precession, Multiply(nutation, AboutZ(-eqe)));
+    }
+
+    /*
+     * rotations to the celestial frame worked out on the block boundaries
+     * either side of a time, kept while times stay within the block
+     */
+    class CelestialCache
+    {
+    public:
+        CelestialCache()
+            : block_(0)
+            , valid_(false)
+            , start_()
+            , end_()
+        {
+        }
+
+        Rotation Find(const DateTime& dt)
+        {
+            const int64_t ticks = dt.Ticks();
+            const int64_t block = ticks / kCelestialBlock;
+            if (!valid_ || block != block_)
+            {
+                if (valid_ && block == block_ + 1)
+                {
+                    start_ = end_;
+                }
+                else
+                {
+                    start_ = CelestialRotation(DateTime(block
+                                * kCelestialBlock));
+                }
+                end_ = CelestialRotation(DateTime((block + 1)
+                            * kCelestialBlock));
+                block_ = block;
+                valid_ = true;
+            }
+
+            const double f = static_cast<double>(ticks
+                    - block * kCelestialBlock)
+                / static_cast<double>(kCelestialBlock);
+
+            Rotation r;
+            for (int i = 0; i < 3; i++)
+            {
+                for (int j = 0; j < 3; j++)
+                {
+                    r.m[i][j] = start_.m[i][j]
+                        + f * (end_.m[i][j] - start_.m[i][j]);
+                }
+            }
+            return r;
+        }
+
+    private:
+        int64_t block_;
+        bool valid_;
+        Rotation start_;
+        Rotation end_;
+    };
+
+    /*
+     * TEME to earth fixed, given the polar motion rotation
+     */
+    FrameState EarthFixed(const Eci& teme,
+            double gmst,
+            const Rotation& polar)
+    {
+        Vector position;
+        Vector velocity;
+        StationFrame::ToEarthFixed(teme.Position(), teme.Velocity(),
+                sin(gmst), cos(gmst), position, velocity);
+        position.w = teme.Position().w;
+
+        FrameState state;
+        state.position = Apply(polar, position);
+        state.velocity = Apply(polar, velocity);
+        state.velocity.w = state.velocity.Magnitude();
+        return state;
+    }
+}
+
+FrameState FrameConverter::ToEcef(const Eci& teme) const
+{
+    return EarthFixed(teme, teme.GetDateTime().ToGreenwichSiderealTime(),
+            PolarMotion(xp_, yp_));
+}
+
+void FrameConverter::ToEcef(
+        const std::vector<Eci>& teme,
+        std::vector<FrameState>& ecef) const
+{
+    const Rotation polar = PolarMotion(xp_, yp_);
+
+    ecef.resize(teme.size());
+    DateTime time;
+    double gmst = 0.0;
+    for (size_t i = 0; i < teme.size(); i++)
+    {
+        if (i == 0 || teme[i].GetDateTime() != time)
+        {
+            time = teme[i].GetDateTime();
+            gmst = time.ToGreenwichSiderealTime();
+        }
+        ecef[i] = EarthFixed(teme[i], gmst, polar);
+    }
+}
+
+FrameState FrameConverter::ToGcrf(const Eci& teme) const
+{
+    const Rotation rotation = CelestialRotation(teme.GetDateTime());
+
+    FrameState state;
+    state.position = Apply(rotation, teme.Position());
+    state.velocity = Apply(rotation, teme.Velocity());
+    return state;
+}
+
+void FrameConverter::ToGcrf(
+        const std::vector<Eci>& teme,
+        std::vector<FrameState>& gcrf) const
+{
+    CelestialCache cache;
+
+    gcrf.resize(teme.size());
+    DateTime time;
+    Rotation rotation = Rotation();
+    for (size_t i = 0; i < teme.size(); i++)
+    {
+        if (i == 0 || teme[i].GetDateTime() != time)
+        {
+            time = teme[i].GetDateTime();
+            rotation = cache.Find(time);
+        }
+        gcrf[i].position = Apply(rotation, teme[i].Position());
+        gcrf[i].velocity = Apply(rotation, teme[i].Velocity());
+    }
+}
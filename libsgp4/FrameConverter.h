@@ -0,0 +1,110 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FRAMECONVERTER_H_
+#define FRAMECONVERTER_H_
+
+#include "DateTime.h"
+#include "Eci.h"
+#include "Vector.h"
+
+#include <vector>
+
+/**
+ * @brief A position and velocity in the frame converted to.
+ */
+struct FrameState
+{
+    /** position in kilometres */
+    Vector position;
+    /** velocity in kilometres per second */
+    Vector velocity;
+};
+
+/**
+ * @brief Converts SGP4 states from the TEME frame to earth fixed or
+ * celestial frames.
+ *
+ * Earth fixed (ITRF) states are rotated by the greenwich mean sidereal time
+ * and, if set, by the polar motion. Celestial (GCRF) states go through the
+ * equation of the equinoxes, the IAU 1980 nutation truncated to its terms
+ * above 0.002 arcseconds, and the IAU 1976 precession, as in Vallado's
+ * reduction. The differences between UTC, UT1 and TT and the frame bias of
+ * GCRF are neglected, so the result is good to a few metres, well inside
+ * the accuracy of SGP4.
+ *
+ * Converting a set of states works out each rotation once per distinct time
+ * and applies it as a matrix to every state at that time. The celestial
+ * rotation changes slowly, so it is worked out on the hour and interpolated
+ * in between.
+ */
+class FrameConverter
+{
+public:
+    FrameConverter()
+        : xp_(0.0)
+        , yp_(0.0)
+    {
+    }
+
+    /**
+     * Set the polar motion used for earth fixed states
+     * @param[in] xp the x pole coordinate in radians
+     * @param[in] yp the y pole coordinate in radians
+     */
+    void SetPolarMotion(double xp, double yp)
+    {
+        xp_ = xp;
+        yp_ = yp;
+    }
+
+    /**
+     * Convert a state to the earth fixed frame
+     * @param[in] teme the state from SGP4
+     * @returns the earth fixed state
+     */
+    FrameState ToEcef(const Eci& teme) const;
+
+    /**
+     * Convert states to the earth fixed frame
+     * @param[in] teme the states from SGP4
+     * @param[out] ecef receives the earth fixed states
+     */
+    void ToEcef(const std::vector<Eci>& teme,
+            std::vector<FrameState>& ecef) const;
+
+    /**
+     * Convert a state to the celestial frame
+     * @param[in] teme the state from SGP4
+     * @returns the celestial state
+     */
+    FrameState ToGcrf(const Eci& teme) const;
+
+    /**
+     * Convert states to the celestial frame
+     * @param[in] teme the states from SGP4
+     * @param[out] gcrf receives the celestial states
+     */
+    void ToGcrf(const std::vector<Eci>& teme,
+            std::vector<FrameState>& gcrf) const;
+
+private:
+    double xp_;
+    double yp_;
+};
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "GeodeticBatch.h"
+
+#include "Globals.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /*
+     * positions worked on at a time, sized so the working arrays stay on
+     * the stack
+     */
+    static const size_t kChunk = 64;
+
+    /*
+     * Bowring iterations, each of which cubes the error of the last
+     */
+    static const int kIterations = 2;
+}
+
+void GeodeticBatch::Convert(
+        size_t count,
+        const double* x,
+        const double* y,
+        const double* z,
+        const double* gmst,
+        double* latitude,
+        double* longitude,
+        double* altitude)
+{
+    static const double a = kXKMPER;
+    static const double b = kXKMPER * (1.0 - kF);
+    static const double e2 = kF * (2.0 - kF);
+    static const double ep2 = e2 / ((1.0 - kF) * (1.0 - kF));
+
+    for (size_t first = 0; first < count; first += kChunk)
+    {
+        const size_t n = std::min(kChunk, count - first);
+
+        /*
+         * distance from the polar axis, and the sine and cosine of the
+         * reduced latitude, starting from the geocentric direction
+         */
+        double p[kChunk];
+        double s[kChunk];
+        double c[kChunk];
+        for (size_t i = 0; i < n; i++)
+        {
+            const double xi = x[first + i];
+            const double yi = y[first + i];
+            const double zi = z[first + i];
+            p[i] = sqrt(xi * xi + yi * yi);
+            const double r = sqrt(zi * zi
+                    + (1.0 - kF) * (1.0 - kF) * p[i] * p[i]);
+            s[i] = zi / r;
+            c[i] = (1.0 - kF) * p[i] / r;
+        }
+
+        /*
+         * the geodetic latitude is along (u, v), and the reduced latitude
+         * has tangent (1 - f) u / v
+         */
+        double u[kChunk];
+        double v[kChunk];
+        for (int iteration = 0; iteration <= kIterations; iteration++)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                u[i] = z[first + i] + ep2 * b * s[i] * s[i] * s[i];
+                v[i] = p[i] - e2 * a * c[i] * c[i] * c[i];
+            }
+            if (iteration == kIterations)
+            {
+                break;
+            }
+            for (size_t i = 0; i < n; i++)
+            {
+                const double r = sqrt((1.0 - kF) * (1.0 - kF) * u[i] * u[i]
+                        + v[i] * v[i]);
+                s[i] = (1.0 - kF) * u[i] / r;
+                c[i] = v[i] / r;
+            }
+        }
+
+        /*
+         * height along the normal, which stays well conditioned at the
+         * poles
+         */
+        for (size_t i = 0; i < n; i++)
+        {
+            const double r = sqrt(u[i] * u[i] + v[i] * v[i]);
+            const double sin_lat = u[i] / r;
+            const double cos_lat = v[i] / r;
+            altitude[first + i] = p[i] * cos_lat + z[first + i] * sin_lat
+                - a * sqrt(1.0 - e2 * sin_lat * sin_lat);
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            latitude[first + i] = atan2(u[i], v[i]);
+            longitude[first + i] = Util::WrapNegPosPI(
+                    atan2(y[first + i], x[first + i]) - gmst[first + i]);
+        }
+    }
+}
+
+void GeodeticBatch::Convert(
+        const std::vector<Eci>& states,
+        const std::vector<double>& gmst,
+        std::vector<CoordGeodetic>& geo)
+{
+    if (gmst.size() != states.size())
+    {
+        throw std::invalid_argument("One sidereal time needed per state");
+    }
+
+    geo.resize(states.size());
+
+    for (size_t first = 0; first < states.size(); first += kChunk)
+    {
+        const size_t n = std::min(kChunk, states.size() - first);
+
+        double x[kChunk];
+        double y[kChunk];
+        double z[kChunk];
+        for (size_t i = 0; i < n; i++)
+        {
+            const Vector position = states[first + i].Position();
+            x[i] = position.x;
+            y[i] = position.y;
+            z[i] = position.z;
+        }
+
+        double latitude[kChunk];
+        double longitude[kChunk];
+        double altitude[kChunk];
+        Convert(n, x, y, z, gmst.data() + first,
+                latitude, longitude, altitude);
+
+        for (size_t i = 0; i < n; i++)
+        {
+            geo[first + i] = CoordGeodetic(latitude[i], longitude[i],
+                    altitude[i], true);
+        }
+    }
+}
+
+void GeodeticBatch::Convert(
+        const std::vector<Eci>& states,
+        std::vector<CoordGeodetic>& geo)
+{
+    std::vector<double> gmst(states.size());
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        gmst[i] = states[i].GetDateTime().ToGreenwichSiderealTime();
+    }
+    Convert(states, gmst, geo);
+}
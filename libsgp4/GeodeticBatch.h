@@ -0,0 +1,88 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GEODETICBATCH_H_
+#define GEODETICBATCH_H_
+
+#include "CoordGeodetic.h"
+#include "Eci.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Converts many positions to geodetic coordinates at once.
+ *
+ * Eci::ToGeodetic iterates on the latitude until it settles, with a sine
+ * and an arctangent each time round. Here two iterations of Bowring's
+ * method are always done, worked through in terms of the direction of the
+ * reduced latitude so that only square roots and arithmetic are needed
+ * until the final arctangents. This agrees with Eci::ToGeodetic to well
+ * under a millimetre from the surface out past geostationary altitude, and
+ * the arithmetic runs as loops over arrays which the compiler can
+ * vectorise. The loops with square roots only vectorise when they need
+ * not set errno, e.g. with -fno-math-errno.
+ */
+class GeodeticBatch
+{
+public:
+    /**
+     * Convert earth centred inertial positions held as arrays
+     * @param[in] count the number of positions
+     * @param[in] x the x coordinates in kilometres
+     * @param[in] y the y coordinates in kilometres
+     * @param[in] z the z coordinates in kilometres
+     * @param[in] gmst the greenwich mean sidereal time of each position in
+     *            radians
+     * @param[out] latitude receives the latitudes in radians
+     * @param[out] longitude receives the longitudes in radians, -pi to pi
+     * @param[out] altitude receives the altitudes in kilometres
+     */
+    static void Convert(size_t count,
+            const double* x,
+            const double* y,
+            const double* z,
+            const double* gmst,
+            double* latitude,
+            double* longitude,
+            double* altitude);
+
+    /**
+     * Convert satellite states
+     * @param[in] states the states to convert
+     * @param[in] gmst the greenwich mean sidereal time of each state in
+     *            radians
+     * @param[out] geo receives the geodetic positions
+     * @exception std::invalid_argument if there is not one time per state
+     */
+    static void Convert(const std::vector<Eci>& states,
+            const std::vector<double>& gmst,
+            std::vector<CoordGeodetic>& geo);
+
+    /**
+     * Convert satellite states, working out the sidereal time of each
+     * @param[in] states the states to convert
+     * @param[out] geo receives the geodetic positions
+     */
+    static void Convert(const std::vector<Eci>& states,
+            std::vector<CoordGeodetic>& geo);
+
+private:
+    GeodeticBatch() = delete;
+};
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "GroundTrackStream.h"
+
+#include "GeodeticBatch.h"
+#include "Globals.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /*
+     * points waiting to be dropped before one is kept regardless, which
+     * bounds the work of checking the tolerance
+     */
+    static const size_t kMaxPending = 64;
+
+    /*
+     * time steps propagated at once by Propagate
+     */
+    static const size_t kStepsPerFill = 64;
+
+    /*
+     * distance in the longitude and latitude plane from p to the line from
+     * a to b
+     */
+    double Deviation(const GroundTrackPoint& a,
+            const GroundTrackPoint& p,
+            const GroundTrackPoint& b)
+    {
+        const double dx = b.longitude - a.longitude;
+        const double dy = b.latitude - a.latitude;
+        const double px = p.longitude - a.longitude;
+        const double py = p.latitude - a.latitude;
+        const double length_squared = dx * dx + dy * dy;
+
+        double t = 0.0;
+        if (length_squared > 0.0)
+        {
+            t = std::max(0.0, std::min(1.0,
+                        (px * dx + py * dy) / length_squared));
+        }
+
+        const double ex = px - t * dx;
+        const double ey = py - t * dy;
+        return sqrt(ex * ex + ey * ey);
+    }
+}
+
+GroundTrackStream::GroundTrackStream(
+        size_t satellite,
+        size_t chunk_size,
+        const ChunkHandler& handler)
+    : tolerance_(0.0)
+    , handler_(handler)
+    , chunk_size_(std::max<size_t>(1, chunk_size))
+    , started_(false)
+    , have_previous_(false)
+{
+    chunk_.satellite = satellite;
+    chunk_.points.reserve(chunk_size_);
+}
+
+void GroundTrackStream::Add(
+        const std::vector<Eci>& states,
+        const std::vector<double>& gmst)
+{
+    GeodeticBatch::Convert(states, gmst, geo_);
+
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        GroundTrackPoint point;
+        point.time = states[i].GetDateTime();
+        point.latitude = geo_[i].latitude;
+        point.longitude = geo_[i].longitude;
+        point.altitude = geo_[i].altitude;
+        point.starts_segment = false;
+        AddPoint(point);
+    }
+}
+
+void GroundTrackStream::Add(const std::vector<Eci>& states)
+{
+    std::vector<double> gmst(states.size());
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        gmst[i] = states[i].GetDateTime().ToGreenwichSiderealTime();
+    }
+    Add(states, gmst);
+}
+
+void GroundTrackStream::Add(const StateGrid& grid)
+{
+    states_.clear();
+    gmst_.clear();
+    for (unsigned long point = grid.First();
+            point < grid.First() + grid.Size(); point++)
+    {
+        states_.push_back(grid.State(point));
+        gmst_.push_back(grid.SiderealTime(point));
+    }
+    Add(states_, gmst_);
+}
+
+void GroundTrackStream::Propagate(
+        const SGP4& sgp4,
+        const DateTime& start_time,
+        const DateTime& end_time,
+        double step)
+{
+    if (!(step > 0.0))
+    {
+        throw std::invalid_argument("Time step must be positive");
+    }
+
+    if (end_time < start_time)
+    {
+        return;
+    }
+
+    StateGrid grid;
+    SGP4::IntegratorParams integrator;
+    unsigned long first = 0;
+    while (StateGrid::TimeOf(start_time, step, first) < end_time)
+    {
+        size_t count = 0;
+        while (count < kStepsPerFill
+                && StateGrid::TimeOf(start_time, step, first + count)
+                < end_time)
+        {
+            count++;
+        }
+        grid.Fill(sgp4, start_time, step, first, count, &integrator);
+        Add(grid);
+        first += count;
+    }
+
+    states_.assign(1, sgp4.FindPosition(end_time, integrator));
+    Add(states_);
+}
+
+void GroundTrackStream::Finish()
+{
+    EndSegment();
+    have_previous_ = false;
+
+    if (!chunk_.points.empty())
+    {
+        handler_(chunk_);
+        chunk_.points.clear();
+    }
+}
+
+/*
+ * where the track crosses 180 degrees longitude, end the segment at the
+ * crossing and start the next from it on the other side. the crossing is
+ * found by linear interpolation with the longitude carried on past 180
+ * degrees, so steps must be short enough that the satellite moves less
+ * than 180 degrees of longitude between them
+ */
+void GroundTrackStream::AddPoint(const GroundTrackPoint& point)
+{
+    if (have_previous_
+            && fabs(point.longitude - previous_.longitude) > kPI)
+    {
+        const double edge_longitude = previous_.longitude > 0.0 ? kPI : -kPI;
+        const double unwrapped = point.longitude + 2.0 * edge_longitude;
+        const double f = (edge_longitude - previous_.longitude)
+            / (unwrapped - previous_.longitude);
+
+        GroundTrackPoint edge;
+        edge.time = previous_.time.AddSeconds(
+                f * (point.time - previous_.time).TotalSeconds());
+        edge.latitude = previous_.latitude
+            + f * (point.latitude - previous_.latitude);
+        edge.longitude = edge_longitude;
+        edge.altitude = previous_.altitude
+            + f * (point.altitude - previous_.altitude);
+        edge.starts_segment = false;
+
+        Decimate(edge);
+        EndSegment();
+        edge.longitude = -edge_longitude;
+        Decimate(edge);
+    }
+
+    Decimate(point);
+    previous_ = point;
+    have_previous_ = true;
+}
+
+/*
+ * points after the last one kept are held until adding another would take
+ * one of them out of tolerance of the line from the last kept point, at
+ * which time the newest held point is kept and the rest dropped
+ */
+void GroundTrackStream::Decimate(const GroundTrackPoint& point)
+{
+    if (!started_)
+    {
+        Keep(point, true);
+        started_ = true;
+        return;
+    }
+
+    if (pending_.size() < kMaxPending && WithinTolerance(point))
+    {
+        pending_.push_back(point);
+        return;
+    }
+
+    Keep(pending_.back(), false);
+    pending_.assign(1, point);
+}
+
+void GroundTrackStream::Keep(const GroundTrackPoint& point,
+        bool starts_segment)
+{
+    anchor_ = point;
+    chunk_.points.push_back(point);
+    chunk_.points.back().starts_segment = starts_segment;
+
+    if (chunk_.points.size() >= chunk_size_)
+    {
+        handler_(chunk_);
+        chunk_.points.clear();
+    }
+}
+
+void GroundTrackStream::EndSegment()
+{
+    if (!pending_.empty())
+    {
+        Keep(pending_.back(), false);
+        pending_.clear();
+    }
+    started_ = false;
+}
+
+bool GroundTrackStream::WithinTolerance(const GroundTrackPoint& end) const
+{
+    for (size_t i = 0; i < pending_.size(); i++)
+    {
+        if (Deviation(anchor_, pending_[i], end) > tolerance_)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GROUNDTRACKSTREAM_H_
+#define GROUNDTRACKSTREAM_H_
+
+#include "CoordGeodetic.h"
+#include "DateTime.h"
+#include "Eci.h"
+#include "SGP4.h"
+#include "StateGrid.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief A sub satellite point on a ground track.
+ */
+struct GroundTrackPoint
+{
+    /** time of the point */
+    DateTime time;
+    /** geodetic latitude in radians */
+    double latitude;
+    /** longitude in radians, -pi to pi */
+    double longitude;
+    /** altitude in kilometres */
+    double altitude;
+    /** true if the point begins a new segment of the track */
+    bool starts_segment;
+};
+
+/**
+ * @brief A run of points from one ground track.
+ */
+struct GroundTrackChunk
+{
+    /** the satellite the track belongs to */
+    size_t satellite;
+    /** the points, in time order */
+    std::vector<GroundTrackPoint> points;
+};
+
+/**
+ * @brief Turns a stream of satellite states into a ground track, a chunk of
+ * points at a time.
+ *
+ * States are converted to geodetic coordinates in bulk with GeodeticBatch.
+ * The track is split into segments where it crosses 180 degrees longitude,
+ * with a point interpolated on each side of the crossing, so that every
+ * segment can be drawn as straight lines on a map. Points are dropped
+ * while the lines between the points kept stay within a tolerance of them,
+ * measured in longitude and latitude as drawn. Points are passed on in
+ * chunks of a fixed size as they are decided, so only a chunk and the
+ * points since the last one kept are held, however long the track.
+ */
+class GroundTrackStream
+{
+public:
+    /**
+     * Receives each chunk. The chunk is reused once the handler returns.
+     */
+    typedef std::function<void(const GroundTrackChunk&)> ChunkHandler;
+
+    /**
+     * Constructor
+     * @param[in] satellite the index given to the chunks
+     * @param[in] chunk_size the number of points in a full chunk
+     * @param[in] handler receives the chunks
+     */
+    GroundTrackStream(size_t satellite,
+            size_t chunk_size,
+            const ChunkHandler& handler);
+
+    /**
+     * Set how far a dropped point may be from the track drawn through the
+     * points kept. Zero keeps every point not exactly in line with its
+     * neighbours.
+     * @param[in] tolerance the tolerance in radians
+     */
+    void SetTolerance(double tolerance)
+    {
+        tolerance_ = tolerance;
+    }
+
+    /**
+     * Add states following on in time from any already added
+     * @param[in] states the states in time order
+     * @param[in] gmst the greenwich mean sidereal time of each state in
+     *            radians
+     * @exception std::invalid_argument if there is not one time per state
+     */
+    void Add(const std::vector<Eci>& states,
+            const std::vector<double>& gmst);
+
+    /**
+     * Add states following on in time from any already added, working out
+     * the sidereal time of each
+     * @param[in] states the states in time order
+     */
+    void Add(const std::vector<Eci>& states);
+
+    /**
+     * Add the states held in a grid, following on in time from any already
+     * added
+     * @param[in] grid the states
+     */
+    void Add(const StateGrid& grid);
+
+    /**
+     * Propagate a satellite and add its states, a block of steps at a time.
+     * The end time is included.
+     * @param[in] sgp4 the satellite
+     * @param[in] start_time the time of the first state
+     * @param[in] end_time the time of the last state
+     * @param[in] step the time between states in seconds
+     * @exception std::invalid_argument if the step is not positive
+     * @exception SatelliteException if propagation fails
+     */
+    void Propagate(const SGP4& sgp4,
+            const DateTime& start_time,
+            const DateTime& end_time,
+            double step);
+
+    /**
+     * End the track, passing on the last point and any part full chunk.
+     * States added after this start a new segment.
+     */
+    void Finish();
+
+private:
+    void AddPoint(const GroundTrackPoint& point);
+    void Decimate(const GroundTrackPoint& point);
+    void Keep(const GroundTrackPoint& point, bool starts_segment);
+    void EndSegment();
+    bool WithinTolerance(const GroundTrackPoint& end) const;
+
+    double tolerance_;
+    ChunkHandler handler_;
+    GroundTrackChunk chunk_;
+    size_t chunk_size_;
+    /** whether a point has been kept in the current segment */
+    bool started_;
+    /** the last point kept */
+    GroundTrackPoint anchor_;
+    /** points since the last one kept */
+    std::vector<GroundTrackPoint> pending_;
+    /** the last point added, to find crossings of 180 degrees */
+    bool have_previous_;
+    GroundTrackPoint previous_;
+    /** reused conversion buffers */
+    std::vector<Eci> states_;
+    std::vector<double> gmst_;
+    std::vector<CoordGeodetic> geo_;
+};
+
+#endif
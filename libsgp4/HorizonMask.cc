@@ -0,0 +1,82 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "HorizonMask.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+HorizonMask::HorizonMask(
+        const std::vector<double>& azimuths,
+        const std::vector<double>& elevations,
+        size_t resolution)
+{
+    if (azimuths.empty() || azimuths.size() != elevations.size())
+    {
+        throw std::invalid_argument("Invalid horizon mask points");
+    }
+
+    std::vector<std::pair<double, double> > points;
+    for (size_t i = 0; i < azimuths.size(); i++)
+    {
+        points.push_back(std::make_pair(
+                    Util::WrapTwoPI(azimuths[i]), elevations[i]));
+    }
+    std::sort(points.begin(), points.end());
+
+    resolution = std::max<size_t>(resolution, 1);
+    scale_ = static_cast<double>(resolution) / kTWOPI;
+
+    /*
+     * interpolate each entry between the points either side of it, wrapping
+     * around north
+     */
+    table_.resize(resolution + 1);
+    size_t next = 0;
+    for (size_t k = 0; k < resolution; k++)
+    {
+        const double azimuth = static_cast<double>(k) / scale_;
+        while (next < points.size() && points[next].first < azimuth)
+        {
+            next++;
+        }
+
+        const std::pair<double, double>& after =
+            points[next % points.size()];
+        const std::pair<double, double>& before =
+            points[(next + points.size() - 1) % points.size()];
+
+        double span = after.first - before.first;
+        double offset = azimuth - before.first;
+        if (span <= 0.0)
+        {
+            span += kTWOPI;
+        }
+        if (offset < 0.0)
+        {
+            offset += kTWOPI;
+        }
+
+        table_[k] = before.second
+            + (after.second - before.second) * offset / span;
+    }
+    table_[resolution] = table_[0];
+
+    min_elevation_ = *std::min_element(table_.begin(), table_.end());
+    max_elevation_ = *std::max_element(table_.begin(), table_.end());
+}
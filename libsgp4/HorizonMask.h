@@ -0,0 +1,121 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef HORIZONMASK_H_
+#define HORIZONMASK_H_
+
+#include "Globals.h"
+#include "Util.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief The lowest elevation visible from an observer in each direction.
+ *
+ * The mask is given as points around the horizon, interpolated linearly in
+ * azimuth, and is held as a dense table so that a lookup costs the same
+ * however many points were given.
+ */
+class HorizonMask
+{
+public:
+    /**
+     * Constructor
+     * @param[in] azimuths the azimuths of the mask points in radians
+     * @param[in] elevations the mask elevation at each point in radians
+     * @param[in] resolution the number of table entries around the horizon
+     * @exception std::invalid_argument if there are no points or the
+     *            number of azimuths and elevations differ
+     */
+    HorizonMask(const std::vector<double>& azimuths,
+            const std::vector<double>& elevations,
+            size_t resolution = 3600);
+
+    /**
+     * @param[in] azimuth the azimuth in radians
+     * @returns the mask elevation in radians
+     */
+    double Elevation(double azimuth) const
+    {
+        const double x = Position(azimuth);
+        const size_t i = Entry(x);
+        const double f = x - static_cast<double>(i);
+        return table_[i] + f * (table_[i + 1] - table_[i]);
+    }
+
+    /**
+     * @param[in] azimuth the azimuth in radians
+     * @returns the rate of change of the mask elevation with azimuth
+     */
+    double Slope(double azimuth) const
+    {
+        const size_t i = Entry(Position(azimuth));
+        return (table_[i + 1] - table_[i]) * scale_;
+    }
+
+    /**
+     * @returns the lowest mask elevation in radians
+     */
+    double MinElevation() const
+    {
+        return min_elevation_;
+    }
+
+    /**
+     * @returns the highest mask elevation in radians
+     */
+    double MaxElevation() const
+    {
+        return max_elevation_;
+    }
+
+private:
+    /*
+     * position of an azimuth in the table, in entries
+     */
+    double Position(double azimuth) const
+    {
+        if (azimuth < 0.0 || azimuth >= kTWOPI)
+        {
+            azimuth = Util::WrapTwoPI(azimuth);
+        }
+        return azimuth * scale_;
+    }
+
+    /*
+     * the entry at the start of the interval holding a position
+     */
+    size_t Entry(double position) const
+    {
+        const size_t i = static_cast<size_t>(position);
+        if (i >= table_.size() - 1)
+        {
+            return table_.size() - 2;
+        }
+        return i;
+    }
+
+    /** one more entry than the resolution, the last repeating the first */
+    std::vector<double> table_;
+    /** table entries per radian */
+    double scale_;
+    double min_elevation_;
+    double max_elevation_;
+};
+
+#endif
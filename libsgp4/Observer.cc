@@ -18,56 +18,54 @@
 #include "Observer.h"
 
 #include "CoordTopocentric.h"
+#include "Globals.h"
+
+#include <cmath>
 
 /*
  * calculate lookangle between the observer and the passed in Eci object
  */
-CoordTopocentric Observer::GetLookAngle(const Eci &eci)
+CoordTopocentric Observer::GetLookAngle(const Eci &eci) const
+{
+    return GetLookAngle(eci, eci.GetDateTime().ToGreenwichSiderealTime());
+}
+
+CoordTopocentric Observer::GetLookAngle(const Eci &eci, double gmst) const
 {
     /*
-     * update the observers Eci to match the time of the Eci passed in
-     * if necessary
+     * rotate the object into the earth fixed frame, its velocity being
+     * relative to the turning earth
      */
-    Update(eci.GetDateTime());
+    Vector fixed_position;
+    Vector fixed_velocity;
+    StationFrame::ToEarthFixed(eci.Position(), eci.Velocity(),
+            sin(gmst), cos(gmst), fixed_position, fixed_velocity);
 
     /*
      * calculate differences
      */
-    Vector range_rate = eci.Velocity() - m_eci.Velocity();
-    Vector range = eci.Position() - m_eci.Position();
-
-    range.w = range.Magnitude();
+    const Vector& station = m_frame.Position();
+    const Vector range(fixed_position.x - station.x,
+            fixed_position.y - station.y,
+            fixed_position.z - station.z);
+    const double range_length = range.Magnitude();
 
     /*
-     * Calculate Local Mean Sidereal Time for observers longitude
+     * rotate the range into the observers east, north and up axes
      */
-    double theta = eci.GetDateTime().ToLocalMeanSiderealTime(m_geo.longitude);
-
-    double sin_lat = sin(m_geo.latitude);
-    double cos_lat = cos(m_geo.latitude);
-    double sin_theta = sin(theta);
-    double cos_theta = cos(theta);
-
-    double top_s = sin_lat * cos_theta * range.x
-        + sin_lat * sin_theta * range.y - cos_lat * range.z;
-    double top_e = -sin_theta * range.x
-        + cos_theta * range.y;
-    double top_z = cos_lat * cos_theta * range.x 
-        + cos_lat * sin_theta * range.y + sin_lat * range.z;
-    double az = atan(-top_e / top_s);
-
-    if (top_s > 0.0)
-    {
-        az += kPI;
-    }
+    double top_e;
+    double top_n;
+    double top_z;
+    m_frame.ToLocal(range, top_e, top_n, top_z);
 
+    double az = atan2(top_e, top_n);
     if (az < 0.0)
     {
-        az += 2.0 * kPI;
+        az += kTWOPI;
     }
 
-    double el = asin(top_z / range.w);
-    double rate = range.Dot(range_rate) / range.w;
+    const double el = asin(top_z / range_length);
+    const double rate = range.Dot(fixed_velocity) / range_length;
 
     /*
      * azimuth in radians
@@ -77,6 +75,6 @@ CoordTopocentric Observer::GetLookAngle(const Eci &eci)
      */
     return CoordTopocentric(az,
             el,
-            range.w,
+            range_length,
             rate);
 }
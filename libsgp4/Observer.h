@@ -20,12 +20,17 @@
 
 #include "CoordGeodetic.h"
 #include "Eci.h"
+#include "StationFrame.h"
 
-class DateTime;
 struct CoordTopocentric;
 
 /**
- * @brief Stores an observers location in Eci coordinates.
+ * @brief Stores an observers location in earth fixed coordinates.
+ *
+ * The earth fixed position and the local horizontal axes are worked out
+ * when the location is set. Look angles are found by rotating the
+ * satellite into the earth fixed frame, so GetLookAngle does not modify
+ * the observer and one observer may be shared between threads.
  */
 class Observer
 {
@@ -40,7 +45,7 @@ public:
             const double longitude,
             const double altitude)
         : m_geo(latitude, longitude, altitude)
-        , m_eci(DateTime(), m_geo)
+        , m_frame(m_geo)
     {
     }
 
@@ -50,7 +55,7 @@ public:
      */
     Observer(const CoordGeodetic &geo)
         : m_geo(geo)
-        , m_eci(DateTime(), geo)
+        , m_frame(geo)
     {
     }
 
@@ -61,7 +66,7 @@ public:
     void SetLocation(const CoordGeodetic& geo)
     {
         m_geo = geo;
-        m_eci.Update(m_eci.GetDateTime(), m_geo);
+        m_frame = StationFrame(geo);
     }
 
     /**
@@ -78,25 +83,22 @@ public:
      * @param[in] eci the object to find the look angle to
      * @returns the lookup angle
      */
-    CoordTopocentric GetLookAngle(const Eci &eci);
+    CoordTopocentric GetLookAngle(const Eci &eci) const;
 
-private:
     /**
-     * @param[in] dt the date to update the observers position for
+     * Get the look angle for the observers position to the object, using a
+     * sidereal time already worked out for the time of the object
+     * @param[in] eci the object to find the look angle to
+     * @param[in] gmst the greenwich mean sidereal time in radians
+     * @returns the lookup angle
      */
-    void Update(const DateTime &dt)
-    {
-        if (m_eci != dt)
-        {
-            m_eci.Update(dt, m_geo);
-        }
-    }
+    CoordTopocentric GetLookAngle(const Eci &eci, double gmst) const;
 
+private:
     /** the observers position */
     CoordGeodetic m_geo;
-    /** the observers Eci for a particular time */
-    Eci m_eci;
+    /** the observers earth fixed position and axes */
+    StationFrame m_frame;
 };
 
 #endif
-
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "OpticalVisibility.h"
+
+#include "Globals.h"
+#include "Util.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    static const double kSampleStep = 30.0;
+    static const double kTimeTolerance = 0.1;
+    static const int kMaxIterations = 32;
+}
+
+OpticalVisibility::OpticalVisibility(const SolarEphemeris& sun)
+    : sun_(sun)
+    , max_sun_elevation_(Util::DegreesToRadians(-6.0))
+{
+}
+
+/*
+ * angle between the sun and the earths limb as seen from the satellite,
+ * positive when the sun is clear of the earth
+ */
+double OpticalVisibility::ShadowMargin(const Eci& eci) const
+{
+    const Vector satellite = eci.Position();
+    const Vector sun = sun_.FindPosition(eci.GetDateTime());
+
+    const Vector to_sun(sun.x - satellite.x,
+            sun.y - satellite.y,
+            sun.z - satellite.z);
+    const double satellite_distance = satellite.Magnitude();
+
+    const double cos_angle = -satellite.Dot(to_sun)
+        / (satellite_distance * to_sun.Magnitude());
+    const double angle = acos(std::max(-1.0, std::min(1.0, cos_angle)));
+    const double earth_radius =
+        asin(std::min(1.0, kXKMPER / satellite_distance));
+
+    return angle - earth_radius;
+}
+
+double OpticalVisibility::SunElevation(
+        const CoordGeodetic& geo,
+        const DateTime& dt) const
+{
+    return SunElevation(StationFrame(geo), dt);
+}
+
+/*
+ * the sun is turned into earth fixed axes, where the station and its
+ * zenith are fixed
+ */
+double OpticalVisibility::SunElevation(
+        const StationFrame& frame,
+        const DateTime& dt) const
+{
+    const double gmst = dt.ToGreenwichSiderealTime();
+    const Vector sun = StationFrame::ToEarthFixed(sun_.FindPosition(dt),
+            sin(gmst), cos(gmst));
+    const Vector& station = frame.Position();
+
+    const Vector to_sun(sun.x - station.x,
+            sun.y - station.y,
+            sun.z - station.z);
+
+    double east;
+    double north;
+    double up;
+    frame.ToLocal(to_sun, east, north, up);
+
+    return asin(up / to_sun.Magnitude());
+}
+
+/*
+ * positive while the satellite is visible. the smaller of the shadow and
+ * darkness margins, so it is continuous across either changing
+ */
+double OpticalVisibility::Margin(
+        const SGP4& sgp4,
+        const StationFrame& frame,
+        const DateTime& dt) const
+{
+    const double dark = max_sun_elevation_ - SunElevation(frame, dt);
+    return std::min(dark, ShadowMargin(sgp4.FindPosition(dt)));
+}
+
+std::vector<VisibleWindow> OpticalVisibility::FindVisible(
+        const SGP4& sgp4,
+        const CoordGeodetic& geo,
+        const PassDetails& pass) const
+{
+    std::vector<VisibleWindow> windows;
+    const StationFrame frame(geo);
+
+    const double duration = (pass.los - pass.aos).TotalSeconds();
+    const int steps = std::max(1,
+            static_cast<int>(ceil(duration / kSampleStep)));
+
+    DateTime previous_time = pass.aos;
+    double previous = Margin(sgp4, frame, previous_time);
+
+    VisibleWindow window;
+    bool visible = previous > 0.0;
+    if (visible)
+    {
+        window.start = pass.aos;
+    }
+
+    for (int i = 1; i <= steps; i++)
+    {
+        const DateTime current_time = (i == steps)
+            ? pass.los
+            : pass.aos.AddSeconds(duration * i / steps);
+        const double current = Margin(sgp4, frame, current_time);
+
+        if ((current > 0.0) != visible)
+        {
+            const DateTime change = FindChange(sgp4, frame,
+                    previous_time, previous, current_time, current);
+            if (visible)
+            {
+                window.end = change;
+                windows.push_back(window);
+            }
+            else
+            {
+                window.start = change;
+            }
+            visible = !visible;
+        }
+
+        previous_time = current_time;
+        previous = current;
+    }
+
+    if (visible)
+    {
+        window.end = pass.los;
+        windows.push_back(window);
+    }
+
+    return windows;
+}
+
+/*
+ * find where the margin changes sign between two samples, by the illinois
+ * variant of regula falsi
+ */
+DateTime OpticalVisibility::FindChange(
+        const SGP4& sgp4,
+        const StationFrame& frame,
+        const DateTime& time1,
+        double margin1,
+        const DateTime& time2,
+        double margin2) const
+{
+    double t1 = 0.0;
+    double t2 = (time2 - time1).TotalSeconds();
+    double f1 = margin1;
+    double f2 = margin2;
+    double t = t2;
+    int side = 0;
+
+    for (int cnt = 0; cnt < kMaxIterations; cnt++)
+    {
+        const double previous_t = t;
+        t = (t1 * f2 - t2 * f1) / (f2 - f1);
+
+        if (fabs(t - previous_t) < kTimeTolerance
+                || t2 - t1 < kTimeTolerance)
+        {
+            break;
+        }
+
+        const double f = Margin(sgp4, frame, time1.AddSeconds(t));
+        if ((f > 0.0) == (f1 > 0.0))
+        {
+            t1 = t;
+            f1 = f;
+            if (side == 1)
+            {
+                f2 /= 2.0;
+            }
+            side = 1;
+        }
+        else
+        {
+            t2 = t;
+            f2 = f;
+            if (side == -1)
+            {
+                f1 /= 2.0;
+            }
+            side = -1;
+        }
+    }
+
+    return time1.AddSeconds(t);
+}
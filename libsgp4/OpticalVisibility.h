@@ -0,0 +1,128 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef OPTICALVISIBILITY_H_
+#define OPTICALVISIBILITY_H_
+
+#include "CoordGeodetic.h"
+#include "DateTime.h"
+#include "Eci.h"
+#include "PassPredictor.h"
+#include "SGP4.h"
+#include "SolarEphemeris.h"
+#include "StationFrame.h"
+
+#include <vector>
+
+/**
+ * @brief A period during which a satellite can be seen by eye or camera.
+ */
+struct VisibleWindow
+{
+    /** when the satellite becomes visible */
+    DateTime start;
+    /** when the satellite stops being visible */
+    DateTime end;
+};
+
+/**
+ * @brief Finds when a satellite is sunlit while the observer is in darkness.
+ *
+ * The satellite is taken to be in shadow while the centre of the sun is
+ * behind the earth as seen from the satellite. The observer is dark while
+ * the sun is below the maximum sun elevation, -6 degrees (civil twilight)
+ * by default. Sun positions come from a shared SolarEphemeris.
+ */
+class OpticalVisibility
+{
+public:
+    /**
+     * Constructor
+     * @param[in] sun the sun positions, which must outlive this object
+     */
+    explicit OpticalVisibility(const SolarEphemeris& sun);
+
+    /**
+     * Set how high the sun may be at the observer for it to be dark
+     * @param[in] elevation the maximum sun elevation in radians
+     */
+    void SetMaxSunElevation(double elevation)
+    {
+        max_sun_elevation_ = elevation;
+    }
+
+    /**
+     * @returns the maximum sun elevation in radians
+     */
+    double MaxSunElevation() const
+    {
+        return max_sun_elevation_;
+    }
+
+    /**
+     * @param[in] eci the satellite position
+     * @returns true if the satellite is in sunlight
+     */
+    bool IsSunlit(const Eci& eci) const
+    {
+        return ShadowMargin(eci) > 0.0;
+    }
+
+    /**
+     * @param[in] geo the observers position
+     * @param[in] dt the time
+     * @returns the elevation of the sun at the observer in radians
+     */
+    double SunElevation(const CoordGeodetic& geo, const DateTime& dt) const;
+
+    /**
+     * @param[in] frame the observers position and local axes
+     * @param[in] dt the time
+     * @returns the elevation of the sun at the observer in radians
+     */
+    double SunElevation(const StationFrame& frame, const DateTime& dt) const;
+
+    /**
+     * Find the parts of a pass during which the satellite is visible.
+     * Changes are found by sampling the pass every 30 seconds and refined to
+     * a fraction of a second, so briefer visible parts may be missed.
+     * @param[in] sgp4 the satellite
+     * @param[in] geo the observers position
+     * @param[in] pass a pass of the satellite over the observer
+     * @returns the visible parts in time order
+     */
+    std::vector<VisibleWindow> FindVisible(const SGP4& sgp4,
+            const CoordGeodetic& geo,
+            const PassDetails& pass) const;
+
+private:
+    double ShadowMargin(const Eci& eci) const;
+    double Margin(const SGP4& sgp4,
+            const StationFrame& frame,
+            const DateTime& dt) const;
+    DateTime FindChange(const SGP4& sgp4,
+            const StationFrame& frame,
+            const DateTime& time1,
+            double margin1,
+            const DateTime& time2,
+            double margin2) const;
+
+    const SolarEphemeris& sun_;
+    double max_sun_elevation_;
+};
+
+#endif
@@ -33,6 +33,31 @@ OrbitalElements::OrbitalElements(const Tle& tle)
     bstar_ = tle.BStar();
     epoch_ = tle.Epoch();
 
+    RecoverElements();
+}
+
+OrbitalElements::OrbitalElements(const DateTime& epoch,
+        const double mean_anomoly,
+        const double ascending_node,
+        const double argument_perigee,
+        const double eccentricity,
+        const double inclination,
+        const double mean_motion,
+        const double bstar)
+    : mean_anomoly_(mean_anomoly)
+    , ascending_node_(ascending_node)
+    , argument_perigee_(argument_perigee)
+    , eccentricity_(eccentricity)
+    , inclination_(inclination)
+    , mean_motion_(mean_motion)
+    , bstar_(bstar)
+    , epoch_(epoch)
+{
+    RecoverElements();
+}
+
+void OrbitalElements::RecoverElements()
+{
     /*
      * recover original mean motion (xnodp) and semimajor axis (aodp)
      * from input elements
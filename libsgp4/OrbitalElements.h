@@ -31,6 +31,26 @@ class OrbitalElements
 public:
     OrbitalElements(const Tle& tle);
 
+    /**
+     * Constructor from raw elements
+     * @param[in] epoch the element set epoch
+     * @param[in] mean_anomoly mean anomoly in radians
+     * @param[in] ascending_node right ascension of the ascending node in radians
+     * @param[in] argument_perigee argument of perigee in radians
+     * @param[in] eccentricity eccentricity
+     * @param[in] inclination inclination in radians
+     * @param[in] mean_motion mean motion in radians per minute
+     * @param[in] bstar BSTAR drag term
+     */
+    OrbitalElements(const DateTime& epoch,
+            const double mean_anomoly,
+            const double ascending_node,
+            const double argument_perigee,
+            const double eccentricity,
+            const double inclination,
+            const double mean_motion,
+            const double bstar);
+
     /*
      * XMO
      */
@@ -128,6 +148,8 @@ public:
     }
 
 private:
+    void RecoverElements();
+
     double mean_anomoly_;
     double ascending_node_;
     double argument_perigee_;
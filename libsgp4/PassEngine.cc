@@ -0,0 +1,314 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "PassEngine.h"
+
+#include "StateGrid.h"
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+namespace
+{
+    /*
+     * enough observers per task to share most of the propagation cost, while
+     * leaving a task count the pool can balance
+     */
+    static const size_t kObserversPerTask = 64;
+
+    /*
+     * time steps propagated at once, around a low earth orbit at the
+     * default step. observers skipping further than this save propagation
+     */
+    static const size_t kStepsPerFill = 32;
+
+    static const size_t kPassesPerTask = 64;
+}
+
+void PassEngine::SetTimeStep(double seconds)
+{
+    if (!(seconds > 0.0))
+    {
+        throw std::invalid_argument("Time step must be positive");
+    }
+    time_step_ = seconds;
+}
+
+std::vector<StationPass> PassEngine::GeneratePasses(
+        const std::vector<SGP4>& satellites,
+        const std::vector<CoordGeodetic>& observers,
+        const DateTime& start_time,
+        const DateTime& end_time,
+        PassEngineStats* stats) const
+{
+    return GeneratePasses(satellites,
+            observers,
+            std::vector<std::shared_ptr<const HorizonMask> >(
+                observers.size()),
+            start_time,
+            end_time,
+            stats);
+}
+
+std::vector<StationPass> PassEngine::GeneratePasses(
+        const std::vector<SGP4>& satellites,
+        const std::vector<CoordGeodetic>& observers,
+        const std::vector<std::shared_ptr<const HorizonMask> >& masks,
+        const DateTime& start_time,
+        const DateTime& end_time,
+        PassEngineStats* stats) const
+{
+    if (masks.size() != observers.size())
+    {
+        throw std::invalid_argument("One horizon mask needed per observer");
+    }
+
+    const size_t blocks =
+        (observers.size() + kObserversPerTask - 1) / kObserversPerTask;
+    const size_t task_count = satellites.size() * blocks;
+
+    std::vector<std::vector<StationPass> > task_passes(task_count);
+    std::vector<PassEngineStats> task_stats(task_count);
+    std::vector<char> task_failed(task_count, 0);
+
+    WorkStealingPool pool(thread_count_);
+    pool.Run(task_count, [&](size_t task)
+            {
+                const size_t satellite = task / blocks;
+                const size_t first = (task % blocks) * kObserversPerTask;
+                const size_t last =
+                    std::min(first + kObserversPerTask, observers.size());
+                try
+                {
+                    SearchBlock(satellites[satellite], satellite, observers,
+                            masks, first, last, start_time, end_time,
+                            task_passes[task], task_stats[task]);
+                }
+                catch (SatelliteException&)
+                {
+                    task_failed[task] = 1;
+                }
+                catch (DecayedException&)
+                {
+                    task_failed[task] = 1;
+                }
+            });
+
+    /*
+     * tasks are numbered in satellite then observer order, so joining them
+     * in task order gives the same result however they were scheduled
+     */
+    std::vector<StationPass> passes;
+    PassEngineStats counters;
+    for (size_t task = 0; task < task_count; task++)
+    {
+        const size_t satellite = task / blocks;
+        counters.pairs += task_stats[task].pairs;
+        counters.rejected += task_stats[task].rejected;
+        if (task_failed[task])
+        {
+            if (counters.failed.empty() || counters.failed.back() != satellite)
+            {
+                counters.failed.push_back(satellite);
+            }
+        }
+    }
+
+    /*
+     * a satellite failing in one observer block is left out of every block
+     */
+    size_t failed = 0;
+    for (size_t task = 0; task < task_count; task++)
+    {
+        const size_t satellite = task / blocks;
+        while (failed < counters.failed.size()
+                && counters.failed[failed] < satellite)
+        {
+            failed++;
+        }
+        if (failed < counters.failed.size()
+                && counters.failed[failed] == satellite)
+        {
+            continue;
+        }
+        passes.insert(passes.end(),
+                task_passes[task].begin(), task_passes[task].end());
+    }
+
+    counters.passes = passes.size();
+    if (stats != NULL)
+    {
+        *stats = counters;
+    }
+
+    return passes;
+}
+
+std::vector<VisibleStationPass> PassEngine::FindVisiblePasses(
+        const std::vector<SGP4>& satellites,
+        const std::vector<CoordGeodetic>& observers,
+        const std::vector<StationPass>& passes,
+        const OpticalVisibility& visibility) const
+{
+    const size_t task_count =
+        (passes.size() + kPassesPerTask - 1) / kPassesPerTask;
+
+    std::vector<std::vector<VisibleStationPass> > task_passes(task_count);
+
+    WorkStealingPool pool(thread_count_);
+    pool.Run(task_count, [&](size_t task)
+            {
+                const size_t first = task * kPassesPerTask;
+                const size_t last =
+                    std::min(first + kPassesPerTask, passes.size());
+                for (size_t i = first; i < last; i++)
+                {
+                    const StationPass& pass = passes[i];
+                    const std::vector<VisibleWindow> windows =
+                        visibility.FindVisible(
+                                satellites[pass.satellite],
+                                observers[pass.observer],
+                                pass.details);
+
+                    for (size_t k = 0; k < windows.size(); k++)
+                    {
+                        VisibleStationPass visible;
+                        visible.satellite = pass.satellite;
+                        visible.observer = pass.observer;
+                        visible.details = pass.details;
+                        visible.window = windows[k];
+                        task_passes[task].push_back(visible);
+                    }
+                }
+            });
+
+    std::vector<VisibleStationPass> visible_passes;
+    for (size_t task = 0; task < task_count; task++)
+    {
+        visible_passes.insert(visible_passes.end(),
+                task_passes[task].begin(), task_passes[task].end());
+    }
+
+    return visible_passes;
+}
+
+/*
+ * search one satellite against a block of observers. each observer keeps
+ * its own search state and asks for its next sample a whole number of time
+ * steps ahead, so one propagation serves every observer due at that step
+ */
+void PassEngine::SearchBlock(
+        const SGP4& sgp4,
+        size_t satellite,
+        const std::vector<CoordGeodetic>& observers,
+        const std::vector<std::shared_ptr<const HorizonMask> >& masks,
+        size_t first_observer,
+        size_t last_observer,
+        const DateTime& start_time,
+        const DateTime& end_time,
+        std::vector<StationPass>& passes,
+        PassEngineStats& stats) const
+{
+    std::vector<size_t> indices;
+    std::vector<PassPredictor> predictors;
+    std::vector<PassPredictor::SearchState> states;
+
+    const std::shared_ptr<const SGP4> shared_sgp4 =
+        std::make_shared<SGP4>(sgp4);
+
+    for (size_t j = first_observer; j < last_observer; j++)
+    {
+        PassPredictor predictor(shared_sgp4, observers[j]);
+        predictor.SetMinElevation(min_elevation_);
+        predictor.SetTimeStep(time_step_);
+        predictor.SetHorizonMask(masks[j]);
+
+        stats.pairs++;
+        if (!predictor.CanBeVisible())
+        {
+            stats.rejected++;
+            continue;
+        }
+
+        indices.push_back(j);
+        predictors.push_back(predictor);
+        states.push_back(PassPredictor::SearchState(predictor, start_time));
+    }
+
+    if (indices.empty())
+    {
+        return;
+    }
+
+    std::vector<unsigned long> next_steps(indices.size(), 0);
+    std::vector<std::vector<PassDetails> > pass_lists(indices.size());
+
+    /*
+     * propagate a run of steps from the earliest step any observer needs,
+     * then run every observer over the buffered states
+     */
+    StateGrid grid;
+    SGP4::IntegratorParams integrator;
+    unsigned long step = 0;
+    while (StateGrid::TimeOf(start_time, time_step_, step) < end_time)
+    {
+        size_t count = 0;
+        while (count < kStepsPerFill
+                && StateGrid::TimeOf(start_time, time_step_, step + count)
+                < end_time)
+        {
+            count++;
+        }
+        grid.Fill(sgp4, start_time, time_step_, step, count, &integrator);
+
+        for (unsigned long point = step; point < step + count; point++)
+        {
+            const Eci& eci = grid.State(point);
+            const double sin_gmst = grid.SiderealTimes().Sin(point);
+            const double cos_gmst = grid.SiderealTimes().Cos(point);
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                if (next_steps[i] == point)
+                {
+                    next_steps[i] += predictors[i].Search(
+                            states[i],
+                            grid.Time(point),
+                            predictors[i].Evaluate(eci, sin_gmst, cos_gmst),
+                            pass_lists[i]);
+                }
+            }
+        }
+
+        step = *std::min_element(next_steps.begin(), next_steps.end());
+    }
+
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        predictors[i].FinishSearch(states[i], end_time, pass_lists[i]);
+
+        for (size_t k = 0; k < pass_lists[i].size(); k++)
+        {
+            StationPass pass;
+            pass.satellite = satellite;
+            pass.observer = indices[i];
+            pass.details = pass_lists[i][k];
+            passes.push_back(pass);
+        }
+    }
+}
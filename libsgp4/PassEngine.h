@@ -0,0 +1,205 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PASSENGINE_H_
+#define PASSENGINE_H_
+
+#include "CoordGeodetic.h"
+#include "DateTime.h"
+#include "OpticalVisibility.h"
+#include "PassPredictor.h"
+#include "SGP4.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief A pass of one satellite over one observer.
+ */
+struct StationPass
+{
+    /** index of the satellite */
+    size_t satellite;
+    /** index of the observer */
+    size_t observer;
+    /** the pass */
+    PassDetails details;
+};
+
+/**
+ * @brief A part of a pass during which the satellite can be seen.
+ */
+struct VisibleStationPass
+{
+    /** index of the satellite */
+    size_t satellite;
+    /** index of the observer */
+    size_t observer;
+    /** the pass */
+    PassDetails details;
+    /** the visible part of the pass */
+    VisibleWindow window;
+};
+
+/**
+ * @brief Counters from a PassEngine run.
+ */
+struct PassEngineStats
+{
+    PassEngineStats()
+        : pairs(0)
+        , rejected(0)
+        , passes(0)
+    {
+    }
+
+    /** number of satellite and observer pairs */
+    size_t pairs;
+    /** pairs skipped because the satellite can never be visible */
+    size_t rejected;
+    /** passes found */
+    size_t passes;
+    /**
+     * indices of satellites which failed to propagate, for example
+     * because they decayed, in ascending order. none of their passes are
+     * returned
+     */
+    std::vector<size_t> failed;
+};
+
+/**
+ * @brief Finds the passes of many satellites over many observers.
+ *
+ * Pairs which PassPredictor::CanBeVisible rules out are skipped without
+ * propagating, which is most of them for a full catalog over a spread of
+ * ground stations. The remaining work is split into tasks of one satellite
+ * and a block of observers, run on a WorkStealingPool. Within a task the
+ * satellite is propagated once per time step and the result shared by every
+ * observer in the block. Results do not depend on the number of threads.
+ * A satellite which fails to propagate is left out of the results and
+ * listed in PassEngineStats::failed, rather than stopping the whole run.
+ */
+class PassEngine
+{
+public:
+    PassEngine()
+        : min_elevation_(0.0)
+        , time_step_(180.0)
+        , thread_count_(0)
+    {
+    }
+
+    /**
+     * Set the number of threads to search on
+     * @param[in] thread_count the number of threads, or zero for the number
+     *            of hardware threads
+     */
+    void SetThreadCount(unsigned int thread_count)
+    {
+        thread_count_ = thread_count;
+    }
+
+    /**
+     * Set the elevation a satellite must rise above for a pass
+     * @param[in] elevation the minimum elevation in radians
+     */
+    void SetMinElevation(double elevation)
+    {
+        min_elevation_ = elevation;
+    }
+
+    /**
+     * Set the search time step, see PassPredictor::SetTimeStep
+     * @param[in] seconds the time step in seconds
+     * @exception std::invalid_argument if the step is not positive
+     */
+    void SetTimeStep(double seconds);
+
+    /**
+     * Find all passes of every satellite over every observer between two
+     * times.
+     * @param[in] satellites the satellites
+     * @param[in] observers the observers positions
+     * @param[in] start_time the start of the search period
+     * @param[in] end_time the end of the search period
+     * @param[out] stats if not NULL, receives counters for the run
+     * @returns the passes ordered by satellite, observer then time
+     */
+    std::vector<StationPass> GeneratePasses(
+            const std::vector<SGP4>& satellites,
+            const std::vector<CoordGeodetic>& observers,
+            const DateTime& start_time,
+            const DateTime& end_time,
+            PassEngineStats* stats = NULL) const;
+
+    /**
+     * Find all passes of every satellite over every observer between two
+     * times, where each observer may have a horizon mask.
+     * @param[in] satellites the satellites
+     * @param[in] observers the observers positions
+     * @param[in] masks the horizon mask of each observer, NULL for a flat
+     *            horizon
+     * @param[in] start_time the start of the search period
+     * @param[in] end_time the end of the search period
+     * @param[out] stats if not NULL, receives counters for the run
+     * @returns the passes ordered by satellite, observer then time
+     * @exception std::invalid_argument if there is not one mask per observer
+     */
+    std::vector<StationPass> GeneratePasses(
+            const std::vector<SGP4>& satellites,
+            const std::vector<CoordGeodetic>& observers,
+            const std::vector<std::shared_ptr<const HorizonMask> >& masks,
+            const DateTime& start_time,
+            const DateTime& end_time,
+            PassEngineStats* stats = NULL) const;
+
+    /**
+     * Find the parts of passes during which the satellites are sunlit and
+     * the observers are in darkness. The sun positions come from the
+     * ephemeris shared by visibility, so they are worked out once for every
+     * satellite and observer.
+     * @param[in] satellites the satellites passed to GeneratePasses
+     * @param[in] observers the observers passed to GeneratePasses
+     * @param[in] passes passes from GeneratePasses
+     * @param[in] visibility the visibility conditions
+     * @returns the visible parts, in the order of passes
+     */
+    std::vector<VisibleStationPass> FindVisiblePasses(
+            const std::vector<SGP4>& satellites,
+            const std::vector<CoordGeodetic>& observers,
+            const std::vector<StationPass>& passes,
+            const OpticalVisibility& visibility) const;
+
+private:
+    void SearchBlock(const SGP4& sgp4,
+            size_t satellite,
+            const std::vector<CoordGeodetic>& observers,
+            const std::vector<std::shared_ptr<const HorizonMask> >& masks,
+            size_t first_observer,
+            size_t last_observer,
+            const DateTime& start_time,
+            const DateTime& end_time,
+            std::vector<StationPass>& passes,
+            PassEngineStats& stats) const;
+
+    double min_elevation_;
+    double time_step_;
+    unsigned int thread_count_;
+};
+
+#endif
@@ -0,0 +1,545 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "PassPredictor.h"
+
+#include "Eci.h"
+#include "Globals.h"
+#include "StateGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+    /*
+     * allowance for the difference between the geodetic and geocentric
+     * vertical, and for the osculating orbit moving outside the mean one
+     */
+    static const double kVisibilityMargin = 0.5 * kPI / 180.0;
+    static const double kRadiusMargin = 1.05;
+    static const double kRateMargin = 1.1;
+
+    /*
+     * refined times are accurate to this many seconds
+     */
+    static const double kTimeTolerance = 0.01;
+    static const int kMaxIterations = 32;
+
+    /*
+     * how far past its limit a generator follows a pass in progress, so
+     * that a satellite which never sets does not search without end
+     */
+    static const double kMaxOverrunDays = 7.0;
+}
+
+void PassPredictor::SetTimeStep(double seconds)
+{
+    /*
+     * a step which is not positive would never advance the search
+     */
+    if (!(seconds > 0.0))
+    {
+        throw std::invalid_argument("Time step must be positive");
+    }
+    time_step_ = seconds;
+}
+
+std::vector<PassDetails> PassPredictor::GeneratePassList(
+        const DateTime& start_time,
+        const DateTime& end_time) const
+{
+    std::vector<PassDetails> pass_list;
+
+    PassGenerator generator(*this, start_time, end_time);
+
+    PassDetails pass;
+    while (generator.Next(pass))
+    {
+        pass_list.push_back(pass);
+    }
+
+    return pass_list;
+}
+
+PassGenerator::PassGenerator(
+        const PassPredictor& predictor,
+        const DateTime& start_time,
+        const DateTime& end_time)
+    : predictor_(predictor)
+    , state_(predictor, start_time)
+    , end_time_(end_time)
+    , searched_to_(start_time)
+    , step_(0)
+    , finished_(!predictor.CanBeVisible())
+{
+    if (finished_)
+    {
+        searched_to_ = end_time;
+    }
+}
+
+bool PassGenerator::Next(PassDetails& pass)
+{
+    return Next(pass, end_time_);
+}
+
+bool PassGenerator::Next(PassDetails& pass, const DateTime& limit)
+{
+    while (pending_.empty())
+    {
+        if (finished_)
+        {
+            return false;
+        }
+
+        const DateTime current_time = state_.TimeOfStep(step_);
+        if (current_time >= end_time_)
+        {
+            predictor_.FinishSearch(state_, end_time_, pending_);
+            searched_to_ = end_time_;
+            finished_ = true;
+        }
+        else if (current_time >= limit && (!state_.found_aos
+                    || current_time >= limit.AddDays(kMaxOverrunDays)))
+        {
+            /*
+             * stop at the limit, unless finishing a pass
+             */
+            return false;
+        }
+        else
+        {
+            step_ += predictor_.Search(
+                    state_,
+                    current_time,
+                    predictor_.Evaluate(current_time),
+                    pending_);
+            searched_to_ = current_time;
+        }
+    }
+
+    pass = pending_.front();
+    pending_.erase(pending_.begin());
+    return true;
+}
+
+PassPredictor::SearchState::SearchState(
+        const PassPredictor& predictor,
+        const DateTime& start)
+    : start_time(start)
+    , time_step(predictor.time_step_)
+    , found_aos(false)
+{
+    /*
+     * while the satellite is far enough below the horizon that it cannot
+     * rise within a time step, jump straight to the earliest step it could
+     */
+    const double station_radius =
+        predictor.frame_.Position().Magnitude();
+    predictor.VisibilityBounds(station_radius, visible_angle, max_rate);
+}
+
+/*
+ * samples are taken on a grid of time steps from the start time, so that
+ * predictors for different observers sample the satellite at the same times
+ */
+DateTime PassPredictor::SearchState::TimeOfStep(unsigned long step) const
+{
+    return StateGrid::TimeOf(start_time, time_step, step);
+}
+
+/*
+ * process the sample at current_time, appending to pass_list any pass that
+ * it ends. returns the number of time steps to the next sample
+ */
+unsigned long PassPredictor::Search(
+        SearchState& state,
+        const DateTime& current_time,
+        const Sample& current,
+        std::vector<PassDetails>& pass_list) const
+{
+    if (!state.found_aos && Clearance(current) > 0.0)
+    {
+        /*
+         * aos hasnt occured yet, but the satellite is now above horizon
+         * this must have occured since the previous sample
+         */
+        if (state.start_time == current_time)
+        {
+            /*
+             * satellite was already above the horizon at the start,
+             * so use the start time
+             */
+            state.aos_time = state.start_time;
+        }
+        else
+        {
+            /*
+             * find the point at which the satellite crossed the horizon
+             */
+            state.aos_time = FindCrossingPoint(
+                    state.previous_time,
+                    state.previous,
+                    current_time,
+                    current);
+        }
+        state.found_aos = true;
+    }
+    else if (state.found_aos && Clearance(current) < 0.0)
+    {
+        state.found_aos = false;
+        /*
+         * already have the aos, but now the satellite is below the horizon,
+         * so find the los
+         */
+        const DateTime los_time = FindCrossingPoint(
+                state.previous_time,
+                state.previous,
+                current_time,
+                current);
+
+        PassDetails pd;
+        pd.aos = state.aos_time;
+        pd.los = los_time;
+        pd.max_elevation = FindMaxElevation(
+                state.aos_time,
+                los_time,
+                pd.max_elevation_time);
+
+        pass_list.push_back(pd);
+    }
+
+    /*
+     * save current sample
+     */
+    state.previous_time = current_time;
+    state.previous = current;
+
+    /*
+     * move along by one time step, or further if the satellite cannot
+     * become visible before then
+     */
+    if (state.found_aos)
+    {
+        return 1;
+    }
+
+    const double steps = (current.central_angle - state.visible_angle)
+        / state.max_rate / time_step_;
+    if (!(steps > 1.0))
+    {
+        return 1;
+    }
+    return static_cast<unsigned long>(std::min(steps, 1.0e9));
+}
+
+/*
+ * close off a pass still in progress at the end of the search period
+ */
+void PassPredictor::FinishSearch(
+        SearchState& state,
+        const DateTime& end_time,
+        std::vector<PassDetails>& pass_list) const
+{
+    if (state.found_aos)
+    {
+        /*
+         * satellite still above horizon at end of search period, so use end
+         * time as los
+         */
+        state.found_aos = false;
+
+        PassDetails pd;
+        pd.aos = state.aos_time;
+        pd.los = end_time;
+        pd.max_elevation = FindMaxElevation(
+                state.aos_time,
+                end_time,
+                pd.max_elevation_time);
+
+        pass_list.push_back(pd);
+    }
+}
+
+/*
+ * the satellites ground track stays within its inclination of the equator,
+ * so the observer is at least the difference in latitude from it
+ */
+bool PassPredictor::CanBeVisible() const
+{
+    const Vector& station = frame_.Position();
+    const double station_radius = station.Magnitude();
+    const double station_latitude = fabs(asin(station.z / station_radius));
+
+    double visible_angle;
+    double max_rate;
+    VisibilityBounds(station_radius, visible_angle, max_rate);
+
+    const double inclination = sgp4_->GetOrbitalElements().Inclination();
+    const double max_latitude = std::min(inclination, kPI - inclination);
+
+    return station_latitude - max_latitude <= visible_angle;
+}
+
+/*
+ * find the time at which the elevation rate falls to zero between aos and
+ * los. uses the illinois variant of regula falsi on the elevation rate,
+ * which keeps the root bracketed and converges superlinearly
+ */
+double PassPredictor::FindMaxElevation(
+        const DateTime& aos,
+        const DateTime& los,
+        DateTime& max_elevation_time) const
+{
+    const Sample first = Evaluate(aos);
+    if (first.elevation_rate <= 0.0)
+    {
+        /*
+         * already past culmination, only for a pass cut short at the start
+         */
+        max_elevation_time = aos;
+        return first.elevation;
+    }
+
+    const Sample last = Evaluate(los);
+    if (last.elevation_rate >= 0.0)
+    {
+        /*
+         * still rising, only for a pass cut short at the end
+         */
+        max_elevation_time = los;
+        return last.elevation;
+    }
+
+    double t1 = 0.0;
+    double t2 = (los - aos).TotalSeconds();
+    double rate1 = first.elevation_rate;
+    double rate2 = last.elevation_rate;
+    double t = t2;
+    double max_elevation = std::max(first.elevation, last.elevation);
+    int side = 0;
+
+    for (int cnt = 0; cnt < kMaxIterations; cnt++)
+    {
+        const double previous_t = t;
+        t = (t1 * rate2 - t2 * rate1) / (rate2 - rate1);
+
+        const Sample sample = Evaluate(aos.AddSeconds(t));
+        max_elevation = sample.elevation;
+
+        if (fabs(t - previous_t) < kTimeTolerance
+                || t2 - t1 < kTimeTolerance)
+        {
+            break;
+        }
+
+        if (sample.elevation_rate > 0.0)
+        {
+            t1 = t;
+            rate1 = sample.elevation_rate;
+            if (side == 1)
+            {
+                rate2 /= 2.0;
+            }
+            side = 1;
+        }
+        else
+        {
+            t2 = t;
+            rate2 = sample.elevation_rate;
+            if (side == -1)
+            {
+                rate1 /= 2.0;
+            }
+            side = -1;
+        }
+    }
+
+    max_elevation_time = aos.AddSeconds(t);
+    return max_elevation;
+}
+
+/*
+ * find the time at which the clearance above the horizon changes sign
+ * between two samples either side of it. newton steps on the clearance rate are used
+ * while they stay inside the bracket, bisecting otherwise
+ */
+DateTime PassPredictor::FindCrossingPoint(
+        const DateTime& time1,
+        const Sample& sample1,
+        const DateTime& time2,
+        const Sample& sample2) const
+{
+    const double f1 = Clearance(sample1);
+    const double f2 = Clearance(sample2);
+
+    /*
+     * bracket in seconds from time1, lo has the same sign as sample1
+     */
+    double lo = 0.0;
+    double hi = (time2 - time1).TotalSeconds();
+
+    /*
+     * start from the linear interpolation between the samples
+     */
+    double t = hi * f1 / (f1 - f2);
+
+    for (int cnt = 0; cnt < kMaxIterations; cnt++)
+    {
+        const Sample sample = Evaluate(time1.AddSeconds(t));
+        const double f = Clearance(sample);
+
+        if ((f > 0.0) == (f1 > 0.0))
+        {
+            lo = t;
+        }
+        else
+        {
+            hi = t;
+        }
+
+        const double rate = ClearanceRate(sample);
+        double next = t;
+        if (rate != 0.0)
+        {
+            next = t - f / rate;
+        }
+        if (rate == 0.0
+                || next <= std::min(lo, hi) || next >= std::max(lo, hi))
+        {
+            next = (lo + hi) / 2.0;
+        }
+
+        const bool converged = fabs(next - t) < kTimeTolerance;
+        t = next;
+        if (converged)
+        {
+            break;
+        }
+    }
+
+    return time1.AddSeconds(t);
+}
+
+/*
+ * the largest earth central angle at which the satellite could be above the
+ * minimum elevation, and the fastest that the angle can change (radians per
+ * second). the satellite is assumed to be at apogee for the first and moving
+ * at its perigee angular rate, plus the earths rotation, for the second
+ */
+void PassPredictor::VisibilityBounds(double station_radius,
+        double& visible_angle,
+        double& max_rate) const
+{
+    const OrbitalElements& elements = sgp4_->GetOrbitalElements();
+    const double e = elements.Eccentricity();
+    const double max_radius = kRadiusMargin * kXKMPER
+        * elements.RecoveredSemiMajorAxis() * (1.0 + e);
+
+    /*
+     * the satellite must clear the lowest part of any horizon mask
+     */
+    double horizon = min_elevation_;
+    if (mask_)
+    {
+        horizon = std::max(horizon, mask_->MinElevation());
+    }
+
+    const double cos_angle = std::min(1.0,
+            station_radius * cos(horizon) / max_radius);
+    visible_angle = acos(cos_angle) - horizon + kVisibilityMargin;
+
+    const double perigee_rate = elements.RecoveredMeanMotion()
+        * sqrt(1.0 - e * e) / ((1.0 - e) * (1.0 - e)) / 60.0;
+    max_rate = kRateMargin * perigee_rate
+        + kTWOPI * kOMEGA_E / kSECONDS_PER_DAY;
+}
+
+/*
+ * elevation and elevation rate of the satellite as seen by the observer.
+ * working in earth fixed axes the observer and its local axes stand still,
+ * so the rates follow from the satellites velocity relative to the earth
+ */
+PassPredictor::Sample PassPredictor::Evaluate(const DateTime& dt) const
+{
+    return Evaluate(sgp4_->FindPosition(dt));
+}
+
+PassPredictor::Sample PassPredictor::Evaluate(const Eci& eci) const
+{
+    const double gmst = eci.GetDateTime().ToGreenwichSiderealTime();
+    return Evaluate(eci, sin(gmst), cos(gmst));
+}
+
+PassPredictor::Sample PassPredictor::Evaluate(
+        const Eci& eci,
+        double sin_gmst,
+        double cos_gmst) const
+{
+    Vector position;
+    Vector velocity;
+    StationFrame::ToEarthFixed(eci.Position(), eci.Velocity(),
+            sin_gmst, cos_gmst, position, velocity);
+
+    const Vector& station = frame_.Position();
+    const Vector range(position.x - station.x,
+            position.y - station.y,
+            position.z - station.z);
+    const double range_length = range.Magnitude();
+
+    double east;
+    double north;
+    double up;
+    frame_.ToLocal(range, east, north, up);
+    double east_rate;
+    double north_rate;
+    double up_rate;
+    frame_.ToLocal(velocity, east_rate, north_rate, up_rate);
+
+    const double sin_el = up / range_length;
+    const double sin_el_rate = up_rate / range_length
+        - up * range.Dot(velocity)
+        / (range_length * range_length * range_length);
+
+    Sample sample;
+    sample.azimuth = 0.0;
+    sample.azimuth_rate = 0.0;
+    if (mask_)
+    {
+        sample.azimuth = atan2(east, north);
+        if (sample.azimuth < 0.0)
+        {
+            sample.azimuth += kTWOPI;
+        }
+        const double horizontal = east * east + north * north;
+        if (horizontal > 0.0)
+        {
+            sample.azimuth_rate =
+                (north * east_rate - east * north_rate) / horizontal;
+        }
+    }
+    sample.elevation = asin(sin_el);
+    sample.elevation_rate = sin_el_rate / cos(sample.elevation);
+
+    const double cos_angle = position.Dot(station)
+        / (position.Magnitude() * station.Magnitude());
+    sample.central_angle = acos(std::min(1.0, cos_angle));
+
+    return sample;
+}
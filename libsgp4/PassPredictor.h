@@ -0,0 +1,306 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PASSPREDICTOR_H_
+#define PASSPREDICTOR_H_
+
+#include "CoordGeodetic.h"
+#include "DateTime.h"
+#include "HorizonMask.h"
+#include "SGP4.h"
+#include "StationFrame.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief A period during which a satellite is above an observers horizon.
+ */
+struct PassDetails
+{
+    /** acquisition of signal */
+    DateTime aos;
+    /** loss of signal */
+    DateTime los;
+    /** maximum elevation in radians */
+    double max_elevation;
+    /** time of maximum elevation */
+    DateTime max_elevation_time;
+};
+
+/**
+ * @brief Finds the passes of a satellite over an observer.
+ */
+class PassPredictor
+{
+public:
+    /**
+     * Constructor
+     * @param[in] sgp4 the satellite
+     * @param[in] geo the observers position
+     */
+    PassPredictor(const SGP4& sgp4, const CoordGeodetic& geo)
+        : sgp4_(std::make_shared<SGP4>(sgp4))
+        , geo_(geo)
+        , frame_(geo)
+        , min_elevation_(0.0)
+        , time_step_(180.0)
+    {
+    }
+
+    /**
+     * Constructor sharing the satellite with other predictors
+     * @param[in] sgp4 the satellite
+     * @param[in] geo the observers position
+     */
+    PassPredictor(const std::shared_ptr<const SGP4>& sgp4,
+            const CoordGeodetic& geo)
+        : sgp4_(sgp4)
+        , geo_(geo)
+        , frame_(geo)
+        , min_elevation_(0.0)
+        , time_step_(180.0)
+    {
+    }
+
+    /**
+     * Set the elevation the satellite must rise above for a pass
+     * @param[in] elevation the minimum elevation in radians
+     */
+    void SetMinElevation(double elevation)
+    {
+        min_elevation_ = elevation;
+    }
+
+    /**
+     * @returns the minimum elevation in radians
+     */
+    double MinElevation() const
+    {
+        return min_elevation_;
+    }
+
+    /**
+     * Set a horizon mask for the observer. A satellite must be above both
+     * the mask and the minimum elevation to be visible.
+     * Dips below the mask during a pass that are shorter than the time step
+     * may not be found.
+     * @param[in] mask the mask, or NULL for a flat horizon
+     */
+    void SetHorizonMask(const std::shared_ptr<const HorizonMask>& mask)
+    {
+        mask_ = mask;
+    }
+
+    /**
+     * Set the interval at which the elevation is sampled when the satellite
+     * could be above the minimum elevation. Passes shorter than this may be
+     * missed. Longer steps are taken while the satellite is too far below the
+     * horizon to rise within a step.
+     * @param[in] seconds the time step in seconds
+     * @exception std::invalid_argument if the step is not positive
+     */
+    void SetTimeStep(double seconds);
+
+    /**
+     * @returns the time step in seconds
+     */
+    double TimeStep() const
+    {
+        return time_step_;
+    }
+
+    /**
+     * Check from the orbit geometry alone whether the satellite could ever
+     * rise above the minimum elevation. A satellite whose ground track never
+     * comes within its visibility footprint of the observer, for example a
+     * low inclination orbit seen from high latitudes, cannot.
+     * @returns false if the satellite can never be visible
+     */
+    bool CanBeVisible() const;
+
+    /**
+     * Find all passes between two times. A pass in progress at the start or
+     * end time is cut short at that time. Use a PassGenerator to find
+     * passes as they are needed. The aos, los and time of maximum
+     * elevation are refined to well under a second.
+     * @param[in] start_time the start of the search period
+     * @param[in] end_time the end of the search period
+     * @returns the passes in time order
+     */
+    std::vector<PassDetails> GeneratePassList(const DateTime& start_time,
+            const DateTime& end_time) const;
+
+private:
+    friend class PassEngine;
+    friend class PassGenerator;
+
+    /*
+     * the satellite as seen by the observer at one time
+     */
+    struct Sample
+    {
+        /** azimuth in radians, only worked out with a horizon mask */
+        double azimuth;
+        /** rate of change of azimuth in radians per second, as azimuth */
+        double azimuth_rate;
+        /** elevation in radians */
+        double elevation;
+        /** rate of change of elevation in radians per second */
+        double elevation_rate;
+        /** earth central angle between the observer and the satellite */
+        double central_angle;
+    };
+
+    /*
+     * progress of a pass search, so that a satellite sample can be shared
+     * between the searches for several observers
+     */
+    struct SearchState
+    {
+        SearchState(const PassPredictor& predictor, const DateTime& start);
+
+        DateTime TimeOfStep(unsigned long step) const;
+
+        DateTime start_time;
+        double time_step;
+        /** widest central angle at which the satellite can be visible */
+        double visible_angle;
+        /** fastest rate the central angle can close, radians per second */
+        double max_rate;
+        bool found_aos;
+        DateTime aos_time;
+        DateTime previous_time;
+        Sample previous;
+    };
+
+    unsigned long Search(SearchState& state,
+            const DateTime& current_time,
+            const Sample& current,
+            std::vector<PassDetails>& pass_list) const;
+    void FinishSearch(SearchState& state,
+            const DateTime& end_time,
+            std::vector<PassDetails>& pass_list) const;
+    double FindMaxElevation(const DateTime& aos,
+            const DateTime& los,
+            DateTime& max_elevation_time) const;
+    DateTime FindCrossingPoint(const DateTime& time1,
+            const Sample& sample1,
+            const DateTime& time2,
+            const Sample& sample2) const;
+    void VisibilityBounds(double station_radius,
+            double& visible_angle,
+            double& max_rate) const;
+    /*
+     * how far the sample is above the horizon, in radians
+     */
+    double Clearance(const Sample& sample) const
+    {
+        double horizon = min_elevation_;
+        if (mask_)
+        {
+            horizon = std::max(horizon, mask_->Elevation(sample.azimuth));
+        }
+        return sample.elevation - horizon;
+    }
+
+    /*
+     * rate of change of the clearance in radians per second
+     */
+    double ClearanceRate(const Sample& sample) const
+    {
+        if (mask_ && mask_->Elevation(sample.azimuth) > min_elevation_)
+        {
+            return sample.elevation_rate
+                - mask_->Slope(sample.azimuth) * sample.azimuth_rate;
+        }
+        return sample.elevation_rate;
+    }
+
+    Sample Evaluate(const DateTime& dt) const;
+    Sample Evaluate(const Eci& eci) const;
+    Sample Evaluate(const Eci& eci, double sin_gmst, double cos_gmst) const;
+
+    std::shared_ptr<const SGP4> sgp4_;
+    CoordGeodetic geo_;
+    StationFrame frame_;
+    double min_elevation_;
+    double time_step_;
+    std::shared_ptr<const HorizonMask> mask_;
+};
+
+/**
+ * @brief Finds the passes of a satellite over an observer one at a time.
+ *
+ * Each call to Next searches only as far as the end of the next pass, so
+ * asking for the next few passes does not cost a search of the whole
+ * period. Passes are the same as those from PassPredictor::GeneratePassList
+ * over the same period.
+ */
+class PassGenerator
+{
+public:
+    /**
+     * Constructor
+     * @param[in] predictor the satellite, observer and search settings
+     * @param[in] start_time the start of the search period
+     * @param[in] end_time the end of the search period
+     */
+    PassGenerator(const PassPredictor& predictor,
+            const DateTime& start_time,
+            const DateTime& end_time);
+
+    /**
+     * Find the next pass
+     * @param[out] pass receives the pass
+     * @returns false if there are no more passes before the end time
+     */
+    bool Next(PassDetails& pass);
+
+    /**
+     * Find the next pass beginning before a time. The search stops at the
+     * limit unless a pass is in progress there, which is followed for up to
+     * a week past the limit, and resumes from the same point on the next
+     * call, so the limit may be moved later each time.
+     * @param[out] pass receives the pass
+     * @param[in] limit the time to search up to
+     * @returns false if no further pass begins before the limit and ends
+     *          within a week of it
+     */
+    bool Next(PassDetails& pass, const DateTime& limit);
+
+    /**
+     * @returns the time the search has reached
+     */
+    DateTime SearchedTo() const
+    {
+        return searched_to_;
+    }
+
+private:
+    PassPredictor predictor_;
+    PassPredictor::SearchState state_;
+    DateTime end_time_;
+    DateTime searched_to_;
+    unsigned long step_;
+    bool finished_;
+    /** passes found but not yet returned */
+    std::vector<PassDetails> pending_;
+};
+
+#endif
@@ -0,0 +1,272 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "PassSchedule.h"
+
+#include "WorkStealingPool.h"
+
+#include <stdexcept>
+
+namespace
+{
+    /*
+     * searches are bounded by the horizon, so generators are given an end
+     * they will never reach
+     */
+    const DateTime kSearchEnd(9999, 12, 31);
+}
+
+void PassSchedule::SetTimeStep(double seconds)
+{
+    if (!(seconds > 0.0))
+    {
+        throw std::invalid_argument("Time step must be positive");
+    }
+    time_step_ = seconds;
+}
+
+CatalogUpdate PassSchedule::Advance(const Catalog& catalog, const DateTime& now)
+{
+    CatalogUpdate update;
+
+    for (std::map<unsigned int, Track>::const_iterator itr = tracks_.begin();
+            itr != tracks_.end(); ++itr)
+    {
+        if (catalog.Find(itr->first) == NULL)
+        {
+            update.removed.push_back(itr->first);
+        }
+    }
+
+    /*
+     * the searches are staged apart from the current tracks, so that if
+     * anything throws the schedule is left as it was
+     */
+    std::vector<Pending> pending(catalog.Size());
+    size_t count = 0;
+    for (Catalog::const_iterator entry = catalog.begin();
+            entry != catalog.end(); ++entry)
+    {
+        std::map<unsigned int, Track>::iterator current =
+            tracks_.find(entry->first);
+        Pending& work = pending[count++];
+        work.norad_number = entry->first;
+
+        if (current != tracks_.end() && current->second.entry == entry->second)
+        {
+            work.current = &current->second;
+            update.unchanged++;
+        }
+        else
+        {
+            if (current != tracks_.end())
+            {
+                update.updated.push_back(entry->first);
+            }
+            else
+            {
+                update.added.push_back(entry->first);
+            }
+            work.track.entry = entry->second;
+            work.track.start_time = now;
+        }
+    }
+
+    const DateTime horizon_end = now.Add(horizon_);
+
+    WorkStealingPool pool(thread_count_);
+    pool.Run(pending.size(), [&](size_t i)
+            {
+                Pending& work = pending[i];
+                if (work.current != NULL && work.current->failed)
+                {
+                    return;
+                }
+
+                /*
+                 * a satellite which cannot be propagated, for example
+                 * because it decayed, has its passes dropped and is not
+                 * searched again until its element set changes
+                 */
+                bool failed = false;
+                try
+                {
+                    if (work.current != NULL)
+                    {
+                        Extend(*work.current, work.slices, horizon_end);
+                    }
+                    else
+                    {
+                        Search(work.track, horizon_end);
+                    }
+                }
+                catch (SatelliteException&)
+                {
+                    failed = true;
+                }
+                catch (DecayedException&)
+                {
+                    failed = true;
+                }
+                if (failed)
+                {
+                    work.failed = true;
+                    work.track.failed = true;
+                    work.track.links.clear();
+                    work.slices.clear();
+                }
+            });
+
+    /*
+     * nothing has thrown, so bring the tracks up to date
+     */
+    for (size_t i = 0; i < update.removed.size(); i++)
+    {
+        tracks_.erase(update.removed[i]);
+    }
+
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        Pending& work = pending[i];
+        if (work.current == NULL)
+        {
+            tracks_[work.norad_number] = std::move(work.track);
+        }
+        else if (work.failed)
+        {
+            work.current->failed = true;
+            work.current->links.clear();
+        }
+        else
+        {
+            for (size_t j = 0; j < work.slices.size(); j++)
+            {
+                Link& link = work.current->links[j];
+                Slice& slice = work.slices[j];
+
+                while (!link.passes.empty() && link.passes.front().los < now)
+                {
+                    link.passes.pop_front();
+                }
+                link.passes.insert(link.passes.end(),
+                        slice.passes.begin(), slice.passes.end());
+                link.generator = std::move(slice.generator);
+            }
+        }
+    }
+
+    return update;
+}
+
+std::vector<unsigned int> PassSchedule::Failed() const
+{
+    std::vector<unsigned int> failed;
+    for (std::map<unsigned int, Track>::const_iterator itr = tracks_.begin();
+            itr != tracks_.end(); ++itr)
+    {
+        if (itr->second.failed)
+        {
+            failed.push_back(itr->first);
+        }
+    }
+    return failed;
+}
+
+/*
+ * build the links of a new track and search every observer up to the end
+ * of the horizon
+ */
+void PassSchedule::Search(Track& track, const DateTime& horizon_end) const
+{
+    /*
+     * alias the propagator held by the catalog entry
+     */
+    const std::shared_ptr<const SGP4> sgp4(
+            track.entry, &track.entry->GetSGP4());
+
+    for (size_t j = 0; j < observers_.size(); j++)
+    {
+        PassPredictor predictor(sgp4, observers_[j]);
+        predictor.SetMinElevation(min_elevation_);
+        predictor.SetTimeStep(time_step_);
+
+        if (predictor.CanBeVisible())
+        {
+            track.links.push_back(Link(j,
+                        PassGenerator(predictor,
+                            track.start_time,
+                            kSearchEnd)));
+        }
+    }
+
+    PassDetails pass;
+    for (size_t i = 0; i < track.links.size(); i++)
+    {
+        Link& link = track.links[i];
+        while (link.generator.Next(pass, horizon_end))
+        {
+            link.passes.push_back(pass);
+        }
+    }
+}
+
+/*
+ * search every observer of a track from where the last call stopped up to
+ * the end of the horizon, into a slice per link
+ */
+void PassSchedule::Extend(
+        const Track& track,
+        std::vector<Slice>& slices,
+        const DateTime& horizon_end) const
+{
+    slices.reserve(track.links.size());
+
+    PassDetails pass;
+    for (size_t i = 0; i < track.links.size(); i++)
+    {
+        slices.push_back(Slice(track.links[i].generator));
+        Slice& slice = slices.back();
+        while (slice.generator.Next(pass, horizon_end))
+        {
+            slice.passes.push_back(pass);
+        }
+    }
+}
+
+std::vector<ScheduledPass> PassSchedule::Passes() const
+{
+    std::vector<ScheduledPass> passes;
+
+    for (std::map<unsigned int, Track>::const_iterator itr = tracks_.begin();
+            itr != tracks_.end(); ++itr)
+    {
+        const std::vector<Link>& links = itr->second.links;
+        for (size_t i = 0; i < links.size(); i++)
+        {
+            for (size_t k = 0; k < links[i].passes.size(); k++)
+            {
+                ScheduledPass pass;
+                pass.norad_number = itr->first;
+                pass.observer = links[i].observer;
+                pass.details = links[i].passes[k];
+                passes.push_back(pass);
+            }
+        }
+    }
+
+    return passes;
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PASSSCHEDULE_H_
+#define PASSSCHEDULE_H_
+
+#include "Catalog.h"
+#include "CoordGeodetic.h"
+#include "DateTime.h"
+#include "PassPredictor.h"
+#include "TimeSpan.h"
+
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A pass of a catalog satellite over one observer.
+ */
+struct ScheduledPass
+{
+    /** norad number of the satellite */
+    unsigned int norad_number;
+    /** index of the observer */
+    size_t observer;
+    /** the pass */
+    PassDetails details;
+};
+
+/**
+ * @brief Keeps the passes of a catalog over a set of observers up to date
+ * for a rolling period ahead.
+ *
+ * Each call to Advance drops passes which have ended and extends the
+ * search of every satellite and observer pair from where the last call
+ * stopped to the new end of the period, so the steady cost is proportional
+ * to the time added. Satellites whose element set changed are searched
+ * again from the current time. The search of each satellite runs on a
+ * WorkStealingPool.
+ */
+class PassSchedule
+{
+public:
+    /**
+     * Constructor
+     * @param[in] observers the observers positions
+     * @param[in] horizon how far ahead of the current time to keep passes
+     */
+    PassSchedule(const std::vector<CoordGeodetic>& observers,
+            const TimeSpan& horizon)
+        : observers_(observers)
+        , horizon_(horizon)
+        , min_elevation_(0.0)
+        , time_step_(180.0)
+        , thread_count_(0)
+    {
+    }
+
+    /**
+     * Set the elevation a satellite must rise above for a pass. Applies to
+     * satellites first searched after the call.
+     * @param[in] elevation the minimum elevation in radians
+     */
+    void SetMinElevation(double elevation)
+    {
+        min_elevation_ = elevation;
+    }
+
+    /**
+     * Set the search time step, see PassPredictor::SetTimeStep. Applies to
+     * satellites first searched after the call.
+     * @param[in] seconds the time step in seconds
+     * @exception std::invalid_argument if the step is not positive
+     */
+    void SetTimeStep(double seconds);
+
+    /**
+     * Set the number of threads to search on
+     * @param[in] thread_count the number of threads, or zero for the number
+     *            of hardware threads
+     */
+    void SetThreadCount(unsigned int thread_count)
+    {
+        thread_count_ = thread_count;
+    }
+
+    /**
+     * Bring the schedule up to now + horizon. Satellites are matched to the
+     * previous call by norad number; a satellite whose catalog entry has been
+     * replaced has its passes discarded and searched again from now. A pass
+     * is added once the search has passed its aos. A satellite which fails
+     * to propagate has its passes dropped and is listed by Failed until
+     * its entry is replaced. If the call throws, the schedule is left as
+     * it was.
+     * @param[in] catalog the current catalog
+     * @param[in] now the current time
+     * @returns the satellites added, searched again and removed
+     */
+    CatalogUpdate Advance(const Catalog& catalog, const DateTime& now);
+
+    /**
+     * @returns the norad numbers of satellites which failed to propagate,
+     *          in ascending order
+     */
+    std::vector<unsigned int> Failed() const;
+
+    /**
+     * @returns the passes which have not ended, ordered by norad number,
+     *          observer then time
+     */
+    std::vector<ScheduledPass> Passes() const;
+
+private:
+    /*
+     * one observer of a satellite which can be visible to it
+     */
+    struct Link
+    {
+        Link(size_t index, const PassGenerator& gen)
+            : observer(index)
+            , generator(gen)
+        {
+        }
+
+        size_t observer;
+        PassGenerator generator;
+        std::deque<PassDetails> passes;
+    };
+
+    struct Track
+    {
+        Track()
+            : failed(false)
+        {
+        }
+
+        std::shared_ptr<const CatalogEntry> entry;
+        /** the search failed to propagate the satellite */
+        bool failed;
+        DateTime start_time;
+        std::vector<Link> links;
+    };
+
+    /*
+     * the passes found for a link by one call to Advance, added to the link
+     * once every search has finished
+     */
+    struct Slice
+    {
+        explicit Slice(const PassGenerator& gen)
+            : generator(gen)
+        {
+        }
+
+        PassGenerator generator;
+        std::vector<PassDetails> passes;
+    };
+
+    /*
+     * the work of one call to Advance for one satellite. an unchanged
+     * satellite is searched into slices and a new or replaced one into
+     * a track of its own, leaving tracks_ alone until the end
+     */
+    struct Pending
+    {
+        Pending()
+            : norad_number(0)
+            , current(NULL)
+            , failed(false)
+        {
+        }
+
+        unsigned int norad_number;
+        /** the unchanged track, or NULL */
+        Track* current;
+        Track track;
+        std::vector<Slice> slices;
+        /** the search of the unchanged track failed to propagate */
+        bool failed;
+    };
+
+    void Search(Track& track, const DateTime& horizon_end) const;
+
+    void Extend(const Track& track,
+            std::vector<Slice>& slices,
+            const DateTime& horizon_end) const;
+
+    std::vector<CoordGeodetic> observers_;
+    TimeSpan horizon_;
+    double min_elevation_;
+    double time_step_;
+    unsigned int thread_count_;
+    std::map<unsigned int, Track> tracks_;
+};
+
+#endif
@@ -217,7 +217,8 @@ Eci SGP4::FindPosition(double tsince) const
 {
     if (use_deep_space_)
     {
-        return FindPositionSDP4(tsince);
+        IntegratorParams integ_params = integrator_params_;
+        return FindPositionSDP4(tsince, integ_params);
     }
     else
     {
@@ -225,7 +226,26 @@ Eci SGP4::FindPosition(double tsince) const
     }
 }
 
-Eci SGP4::FindPositionSDP4(double tsince) const
+Eci SGP4::FindPosition(const DateTime& dt,
+        IntegratorParams& integrator) const
+{
+    return FindPosition((dt - elements_.Epoch()).TotalMinutes(), integrator);
+}
+
+Eci SGP4::FindPosition(double tsince, IntegratorParams& integrator) const
+{
+    if (use_deep_space_)
+    {
+        return FindPositionSDP4(tsince, integrator);
+    }
+    else
+    {
+        return FindPositionSGP4(tsince);
+    }
+}
+
+Eci SGP4::FindPositionSDP4(double tsince,
+        IntegratorParams& integ_params) const
 {
     /*
      * the final values
@@ -261,7 +281,7 @@ Eci SGP4::FindPositionSDP4(double tsince) const
                      elements_,
                      common_consts_,
                      deepspace_consts_,
-                     integrator_params_,
+                     integ_params,
                      xmdf,
                      omgadf,
                      xnode,
@@ -1344,5 +1364,5 @@ void SGP4::Reset()
     std::memset(&common_consts_, 0, sizeof(common_consts_));
     std::memset(&nearspace_consts_, 0, sizeof(nearspace_consts_));
     std::memset(&deepspace_consts_, 0, sizeof(deepspace_consts_));
-    std::memset(&integrator_params_, 0, sizeof(integrator_params_));
+    integrator_params_ = IntegratorParams();
 }
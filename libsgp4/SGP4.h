@@ -42,10 +42,71 @@ public:
         Initialise();
     }
 
+    SGP4(const OrbitalElements& elements)
+        : elements_(elements)
+    {
+        Initialise();
+    }
+
+    /**
+     * @brief Progress of the resonance integrator for a deep space orbit.
+     *
+     * The 12 and 24 hour resonant orbits are integrated in 720 minute steps
+     * from the epoch. FindPosition without a state starts again from the
+     * epoch on every call, so that a const SGP4 may be shared between
+     * threads, and its cost grows with the time from epoch. A caller
+     * propagating one satellite forward in time can keep a state and pass
+     * it to each call, so that each integration carries on from the last.
+     * A state must only be used with the propagator it was first passed
+     * to, and by one thread at a time.
+     */
+    struct IntegratorParams
+    {
+        IntegratorParams()
+            : xli(0.0)
+            , xni(0.0)
+            , atime(0.0)
+        {
+        }
+
+        /*
+         * integrator values
+         */
+        double xli;
+        double xni;
+        double atime;
+    };
+
     void SetTle(const Tle& tle);
     Eci FindPosition(double tsince) const;
     Eci FindPosition(const DateTime& date) const;
 
+    /**
+     * Propagate, continuing the resonance integration from a state held
+     * by the caller. Results are the same as without the state.
+     * @param[in] tsince the time from epoch in minutes
+     * @param[in,out] integrator the integrator state for this propagator
+     * @returns the satellite state
+     */
+    Eci FindPosition(double tsince, IntegratorParams& integrator) const;
+
+    /**
+     * Propagate, continuing the resonance integration from a state held
+     * by the caller. Results are the same as without the state.
+     * @param[in] date the time to propagate to
+     * @param[in,out] integrator the integrator state for this propagator
+     * @returns the satellite state
+     */
+    Eci FindPosition(const DateTime& date, IntegratorParams& integrator) const;
+
+    /**
+     * @returns the orbital elements the propagator was initialised with
+     */
+    const OrbitalElements& GetOrbitalElements() const
+    {
+        return elements_;
+    }
+
 private:
     struct CommonConstants
     {
@@ -154,15 +215,6 @@ private:
         } shape;
     };
 
-    struct IntegratorParams
-    {
-        /*
-         * integrator values
-         */
-        double xli;
-        double xni;
-        double atime;
-    };
     
     void Initialise();
     static void RecomputeConstants(const double xinc,
@@ -173,7 +225,8 @@ private:
                                    double& x7thm1,
                                    double& xlcof,
                                    double& aycof);
-    Eci FindPositionSDP4(const double tsince) const;
+    Eci FindPositionSDP4(const double tsince,
+            IntegratorParams& integ_params) const;
     Eci FindPositionSGP4(double tsince) const;
     static Eci CalculateFinalPositionVelocity(
             const DateTime& date,
@@ -241,7 +294,11 @@ private:
     struct CommonConstants common_consts_;
     struct NearSpaceConstants nearspace_consts_;
     struct DeepSpaceConstants deepspace_consts_;
-    mutable struct IntegratorParams integrator_params_;
+    /*
+     * integrator state at epoch. FindPosition without a caller state works
+     * on a copy so that a const SGP4 may be shared between threads
+     */
+    struct IntegratorParams integrator_params_;
 
     /*
      * the orbit data
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SharedCatalog.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * propagators are copied into the segment byte for byte
+ */
+static_assert(std::is_trivially_copyable<SGP4>::value,
+        "SGP4 must be trivially copyable to be placed in shared memory");
+
+namespace
+{
+    static const char kSegmentMagic[8] = { 'S', 'G', 'P', '4', 'S', 'H', 'M', '\0' };
+    static const uint32_t kSegmentVersion = 1;
+}
+
+struct SharedCatalog::SegmentHeader
+{
+    char magic[8];
+    uint32_t version;
+    /** sizeof(Record) of the publishing build */
+    uint32_t record_size;
+    uint64_t count;
+    /** ticks at which the segment was published */
+    int64_t published;
+    /** set once the records are complete */
+    std::atomic<uint32_t> ready;
+};
+
+SharedCatalog::SharedCatalog(const std::string& name)
+    : header_(NULL)
+    , records_(NULL)
+    , count_(0)
+    , mapping_(NULL)
+    , mapping_size_(0)
+{
+#ifndef _WIN32
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Failed to open shared catalog");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0
+            || st.st_size < static_cast<off_t>(sizeof(SegmentHeader)))
+    {
+        close(fd);
+        throw std::runtime_error("Shared catalog is not ready");
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Failed to map shared catalog");
+    }
+
+    const SegmentHeader* header = static_cast<const SegmentHeader*>(mapping);
+    if (header->ready.load(std::memory_order_acquire) != 1)
+    {
+        munmap(mapping, size);
+        throw std::runtime_error("Shared catalog is not ready");
+    }
+
+    if (std::memcmp(header->magic, kSegmentMagic, sizeof(kSegmentMagic)) != 0
+            || header->version != kSegmentVersion
+            || header->record_size != sizeof(Record)
+            || sizeof(SegmentHeader) + header->count * sizeof(Record) != size)
+    {
+        munmap(mapping, size);
+        throw std::runtime_error("Incompatible shared catalog");
+    }
+
+    header_ = header;
+    records_ = reinterpret_cast<const Record*>(
+            static_cast<const char*>(mapping) + sizeof(SegmentHeader));
+    count_ = header->count;
+    mapping_ = mapping;
+    mapping_size_ = size;
+#else
+    (void)name;
+    throw std::runtime_error("Shared catalogs are not supported");
+#endif
+}
+
+SharedCatalog::~SharedCatalog()
+{
+#ifndef _WIN32
+    if (mapping_ != NULL)
+    {
+        munmap(mapping_, mapping_size_);
+    }
+#endif
+}
+
+void SharedCatalog::Publish(const std::string& name, const Catalog& catalog)
+{
+#ifndef _WIN32
+    const size_t size = sizeof(SegmentHeader) + catalog.Size() * sizeof(Record);
+
+    /*
+     * create a fresh segment so attached readers keep the old one
+     */
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Failed to create shared catalog");
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Failed to size shared catalog");
+    }
+
+    void* mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Failed to map shared catalog");
+    }
+
+    SegmentHeader* header = new (mapping) SegmentHeader;
+    header->ready.store(0, std::memory_order_relaxed);
+    std::memcpy(header->magic, kSegmentMagic, sizeof(kSegmentMagic));
+    header->version = kSegmentVersion;
+    header->record_size = sizeof(Record);
+    header->count = catalog.Size();
+    header->published = DateTime::Now(true).Ticks();
+
+    /*
+     * catalog iteration is in norad order, which Find relies on
+     */
+    Record* record = reinterpret_cast<Record*>(
+            static_cast<char*>(mapping) + sizeof(SegmentHeader));
+    for (Catalog::const_iterator itr = catalog.begin();
+            itr != catalog.end(); ++itr, ++record)
+    {
+        record->norad_number = itr->first;
+        record->reserved = 0;
+        record->epoch = itr->second->GetTle().Epoch().Ticks();
+        std::memcpy(static_cast<void*>(&record->sgp4),
+                &itr->second->GetSGP4(), sizeof(SGP4));
+    }
+
+    header->ready.store(1, std::memory_order_release);
+    munmap(mapping, size);
+#else
+    (void)name;
+    (void)catalog;
+    throw std::runtime_error("Shared catalogs are not supported");
+#endif
+}
+
+void SharedCatalog::Remove(const std::string& name)
+{
+#ifndef _WIN32
+    shm_unlink(name.c_str());
+#else
+    (void)name;
+#endif
+}
+
+const SGP4* SharedCatalog::Find(unsigned int norad_number) const
+{
+    const Record* end = records_ + count_;
+    const Record* record = std::lower_bound(records_, end, norad_number,
+            [](const Record& r, unsigned int norad)
+            {
+                return r.norad_number < norad;
+            });
+
+    if (record == end || record->norad_number != norad_number)
+    {
+        return NULL;
+    }
+    return &record->sgp4;
+}
+
+DateTime SharedCatalog::Published() const
+{
+    return DateTime(header_->published);
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SHAREDCATALOG_H_
+#define SHAREDCATALOG_H_
+
+#include "Catalog.h"
+#include "SGP4.h"
+
+#include <string>
+#include <stdint.h>
+
+/**
+ * @brief A read only view of a catalog published in shared memory.
+ *
+ * One process publishes an initialised catalog into a named POSIX shared
+ * memory segment, and other processes on the host attach to it without
+ * parsing or initialising anything. The segment holds the propagators
+ * themselves, so it can only be shared between builds of the library with
+ * the same SGP4 layout; this is checked when attaching.
+ */
+class SharedCatalog
+{
+public:
+    /**
+     * Attach read only to a published segment
+     * @param[in] name the segment name, e.g. "/sgp4-catalog"
+     * @exception std::runtime_error if the segment does not exist, is not
+     *            fully published or was written by an incompatible build
+     */
+    explicit SharedCatalog(const std::string& name);
+
+    ~SharedCatalog();
+
+    /**
+     * Publish a catalog, replacing any existing segment of the same name.
+     * Processes attached to the previous segment keep their view of it.
+     * @param[in] name the segment name
+     * @param[in] catalog the catalog to publish
+     * @exception std::runtime_error on failure
+     */
+    static void Publish(const std::string& name, const Catalog& catalog);
+
+    /**
+     * Remove a published segment name. Attached processes are unaffected.
+     * @param[in] name the segment name
+     */
+    static void Remove(const std::string& name);
+
+    /**
+     * @returns the number of satellites
+     */
+    size_t Size() const
+    {
+        return static_cast<size_t>(count_);
+    }
+
+    /**
+     * @param[in] index the satellite index, less than Size()
+     * @returns the norad number of the satellite
+     */
+    unsigned int NoradNumber(size_t index) const
+    {
+        return records_[index].norad_number;
+    }
+
+    /**
+     * @param[in] index the satellite index, less than Size()
+     * @returns the epoch of the satellites element set
+     */
+    DateTime Epoch(size_t index) const
+    {
+        return DateTime(records_[index].epoch);
+    }
+
+    /**
+     * @param[in] index the satellite index, less than Size()
+     * @returns the propagator for the satellite
+     */
+    const SGP4& GetSGP4(size_t index) const
+    {
+        return records_[index].sgp4;
+    }
+
+    /**
+     * Find a satellite
+     * @param[in] norad_number the satellite to find
+     * @returns the propagator, or NULL if the satellite is not present
+     */
+    const SGP4* Find(unsigned int norad_number) const;
+
+    /**
+     * @returns when the segment was published
+     */
+    DateTime Published() const;
+
+private:
+    SharedCatalog(const SharedCatalog&) = delete;
+    SharedCatalog& operator=(const SharedCatalog&) = delete;
+
+    struct Record
+    {
+        uint32_t norad_number;
+        uint32_t reserved;
+        int64_t epoch;
+        SGP4 sgp4;
+    };
+
+    struct SegmentHeader;
+
+    const SegmentHeader* header_;
+    const Record* records_;
+    uint64_t count_;
+    void* mapping_;
+    size_t mapping_size_;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SiderealGrid.h"
+
+#include "Globals.h"
+#include "TimeSpan.h"
+#include "Util.h"
+
+#include <cmath>
+
+namespace
+{
+    /*
+     * rate of the sidereal time in radians per second, as used by
+     * DateTime::ToGreenwichSiderealTime
+     */
+    static const double kSiderealRate = 1.00273790935 * kTWOPI / 86400.0;
+}
+
+void SiderealGrid::Fill(
+        const DateTime& start,
+        double step,
+        unsigned long first,
+        size_t count)
+{
+    first_ = first;
+    angles_.resize(count);
+    sines_.resize(count);
+    cosines_.resize(count);
+
+    int64_t day_start = 0;
+    int64_t day_end = 0;
+    double day_angle = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const int64_t ticks = TimeOf(start, step, first + i).Ticks();
+        if (ticks < day_start || ticks >= day_end)
+        {
+            /*
+             * sidereal time at 0h UT
+             */
+            day_start = ticks - ticks % TicksPerDay;
+            day_end = day_start + TicksPerDay;
+            day_angle = DateTime(day_start).ToGreenwichSiderealTime();
+        }
+
+        const double seconds = static_cast<double>(ticks - day_start)
+            / static_cast<double>(TicksPerSecond);
+        const double angle = Util::WrapTwoPI(day_angle
+                + kSiderealRate * seconds);
+
+        angles_[i] = angle;
+        sines_[i] = sin(angle);
+        cosines_[i] = cos(angle);
+    }
+}
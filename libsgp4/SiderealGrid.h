@@ -0,0 +1,120 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SIDEREALGRID_H_
+#define SIDEREALGRID_H_
+
+#include "DateTime.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Greenwich mean sidereal time over a run of a uniform time grid.
+ *
+ * The grid is start + step * n for integer n, as for StateGrid. The
+ * sidereal time polynomial only changes at 0h UT, so it is evaluated once
+ * per day and the angle is stepped on linearly from there, giving the same
+ * values as DateTime::ToGreenwichSiderealTime. The sine and cosine of each
+ * angle are held too, so that every conversion at a grid point can share
+ * them.
+ */
+class SiderealGrid
+{
+public:
+    SiderealGrid()
+        : first_(0)
+    {
+    }
+
+    /**
+     * Work out the grid points first to first + count - 1, replacing the
+     * current contents
+     * @param[in] start the time of grid point zero
+     * @param[in] step the grid spacing in seconds
+     * @param[in] first the first grid point
+     * @param[in] count the number of grid points
+     */
+    void Fill(const DateTime& start,
+            double step,
+            unsigned long first,
+            size_t count);
+
+    /**
+     * @returns the first grid point held
+     */
+    unsigned long First() const
+    {
+        return first_;
+    }
+
+    /**
+     * @returns the number of grid points held
+     */
+    size_t Size() const
+    {
+        return angles_.size();
+    }
+
+    /**
+     * @param[in] point a grid point from First() to First() + Size() - 1
+     * @returns the greenwich mean sidereal time at the grid point in radians
+     */
+    double Angle(unsigned long point) const
+    {
+        return angles_[point - first_];
+    }
+
+    /**
+     * @param[in] point a grid point from First() to First() + Size() - 1
+     * @returns the sine of the sidereal time at the grid point
+     */
+    double Sin(unsigned long point) const
+    {
+        return sines_[point - first_];
+    }
+
+    /**
+     * @param[in] point a grid point from First() to First() + Size() - 1
+     * @returns the cosine of the sidereal time at the grid point
+     */
+    double Cos(unsigned long point) const
+    {
+        return cosines_[point - first_];
+    }
+
+    /**
+     * @param[in] start the time of grid point zero
+     * @param[in] step the grid spacing in seconds
+     * @param[in] point the grid point
+     * @returns the time of a grid point
+     */
+    static DateTime TimeOf(const DateTime& start,
+            double step,
+            unsigned long point)
+    {
+        return start.AddSeconds(step * static_cast<double>(point));
+    }
+
+private:
+    unsigned long first_;
+    std::vector<double> angles_;
+    std::vector<double> sines_;
+    std::vector<double> cosines_;
+};
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "SolarEphemeris.h"
+
+#include "SolarPosition.h"
+
+#include <cmath>
+#include <stdexcept>
+
+SolarEphemeris::SolarEphemeris(
+        const DateTime& start_time,
+        const DateTime& end_time,
+        double step)
+    : start_time_(start_time)
+    , step_(step)
+{
+    if (end_time < start_time)
+    {
+        throw std::invalid_argument("End time is before start time");
+    }
+    if (!(step_ > 0.0))
+    {
+        throw std::invalid_argument("Step must be positive");
+    }
+
+    SolarPosition solar_position;
+
+    /*
+     * one point either side of the period so every time inside has a pair
+     * to interpolate between
+     */
+    const double span = (end_time - start_time).TotalSeconds();
+    const size_t count = static_cast<size_t>(ceil(span / step_)) + 2;
+
+    positions_.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        positions_.push_back(solar_position.FindPosition(
+                    start_time_.AddSeconds(step_ * static_cast<double>(i)))
+                .Position());
+    }
+}
+
+Vector SolarEphemeris::FindPosition(const DateTime& dt) const
+{
+    const double offset = (dt - start_time_).TotalSeconds() / step_;
+    const double index = floor(offset);
+
+    if (index < 0.0 || index + 1.0 >= static_cast<double>(positions_.size()))
+    {
+        SolarPosition solar_position;
+        return solar_position.FindPosition(dt).Position();
+    }
+
+    const size_t i = static_cast<size_t>(index);
+    const double f = offset - index;
+    const Vector& p0 = positions_[i];
+    const Vector& p1 = positions_[i + 1];
+
+    Vector position(p0.x + f * (p1.x - p0.x),
+            p0.y + f * (p1.y - p0.y),
+            p0.z + f * (p1.z - p0.z));
+    position.w = position.Magnitude();
+    return position;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SOLAREPHEMERIS_H_
+#define SOLAREPHEMERIS_H_
+
+#include "DateTime.h"
+#include "Vector.h"
+
+#include <vector>
+
+/**
+ * @brief Positions of the sun over a period, worked out once and shared.
+ *
+ * SolarPosition is evaluated on a uniform grid across the period and
+ * positions in between are interpolated linearly, which is accurate to well
+ * under an arc second at the default spacing. The ephemeris is read only
+ * once constructed, so one instance may be used by many threads for every
+ * satellite and observer.
+ */
+class SolarEphemeris
+{
+public:
+    /**
+     * Constructor
+     * @param[in] start_time the start of the period
+     * @param[in] end_time the end of the period
+     * @param[in] step the grid spacing in seconds
+     * @exception std::invalid_argument if the end is before the start or
+     *            the step is not positive
+     */
+    SolarEphemeris(const DateTime& start_time,
+            const DateTime& end_time,
+            double step = 600.0);
+
+    /**
+     * Find the position of the sun. Times outside the period are worked out
+     * directly.
+     * @param[in] dt the time
+     * @returns the eci position of the sun in kilometres
+     */
+    Vector FindPosition(const DateTime& dt) const;
+
+private:
+    DateTime start_time_;
+    double step_;
+    std::vector<Vector> positions_;
+};
+
+#endif
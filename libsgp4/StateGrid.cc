@@ -0,0 +1,42 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "StateGrid.h"
+
+void StateGrid::Fill(
+        const SGP4& sgp4,
+        const DateTime& start,
+        double step,
+        unsigned long first,
+        size_t count,
+        SGP4::IntegratorParams* integrator)
+{
+    start_ = start;
+    step_ = step;
+    first_ = first;
+
+    states_.clear();
+    states_.reserve(count);
+    SGP4::IntegratorParams local;
+    SGP4::IntegratorParams& state = integrator != NULL ? *integrator : local;
+    for (size_t i = 0; i < count; i++)
+    {
+        states_.push_back(
+                sgp4.FindPosition(TimeOf(start, step, first + i), state));
+    }
+    sidereal_.Fill(start, step, first, count);
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef STATEGRID_H_
+#define STATEGRID_H_
+
+#include "DateTime.h"
+#include "Eci.h"
+#include "SGP4.h"
+#include "SiderealGrid.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Satellite states propagated over a run of a uniform time grid.
+ *
+ * The grid is start + step * n for integer n. A run of grid points is
+ * propagated in one go, along with the Greenwich sidereal time at each, so
+ * that the states can be evaluated against many observers without
+ * propagating or working out the earths rotation again for each.
+ */
+class StateGrid
+{
+public:
+    StateGrid()
+        : step_(0.0)
+        , first_(0)
+    {
+    }
+
+    /**
+     * Propagate the grid points first to first + count - 1, replacing the
+     * current contents
+     * @param[in] sgp4 the satellite
+     * @param[in] start the time of grid point zero
+     * @param[in] step the grid spacing in seconds
+     * @param[in] first the first grid point to propagate
+     * @param[in] count the number of grid points to propagate
+     * @param[in,out] integrator integrator state carried from one fill of
+     *                the satellite to the next, or NULL
+     * @exception SatelliteException if propagation fails
+     */
+    void Fill(const SGP4& sgp4,
+            const DateTime& start,
+            double step,
+            unsigned long first,
+            size_t count,
+            SGP4::IntegratorParams* integrator = NULL);
+
+    /**
+     * @returns the first grid point held
+     */
+    unsigned long First() const
+    {
+        return first_;
+    }
+
+    /**
+     * @returns the number of grid points held
+     */
+    size_t Size() const
+    {
+        return states_.size();
+    }
+
+    /**
+     * @param[in] point the grid point
+     * @returns the time of the grid point
+     */
+    DateTime Time(unsigned long point) const
+    {
+        return TimeOf(start_, step_, point);
+    }
+
+    /**
+     * @param[in] point a grid point from First() to First() + Size() - 1
+     * @returns the satellite state at the grid point
+     */
+    const Eci& State(unsigned long point) const
+    {
+        return states_[point - first_];
+    }
+
+    /**
+     * @param[in] point a grid point from First() to First() + Size() - 1
+     * @returns the greenwich mean sidereal time at the grid point in radians
+     */
+    double SiderealTime(unsigned long point) const
+    {
+        return sidereal_.Angle(point);
+    }
+
+    /**
+     * @returns the sidereal times of the grid points held, with their sines
+     *          and cosines
+     */
+    const SiderealGrid& SiderealTimes() const
+    {
+        return sidereal_;
+    }
+
+    /**
+     * @param[in] start the time of grid point zero
+     * @param[in] step the grid spacing in seconds
+     * @param[in] point the grid point
+     * @returns the time of a grid point
+     */
+    static DateTime TimeOf(const DateTime& start,
+            double step,
+            unsigned long point)
+    {
+        return SiderealGrid::TimeOf(start, step, point);
+    }
+
+private:
+    DateTime start_;
+    double step_;
+    unsigned long first_;
+    std::vector<Eci> states_;
+    SiderealGrid sidereal_;
+};
+
+#endif
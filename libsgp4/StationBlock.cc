@@ -0,0 +1,190 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "StationBlock.h"
+
+#include "Globals.h"
+#include "StationFrame.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /*
+     * stations worked on at a time, sized so the working arrays stay on
+     * the stack
+     */
+    static const size_t kChunk = 64;
+}
+
+StationBlock::StationBlock(const std::vector<CoordGeodetic>& stations)
+{
+    const size_t count = stations.size();
+    x_.resize(count);
+    y_.resize(count);
+    z_.resize(count);
+    sin_lat_.resize(count);
+    cos_lat_.resize(count);
+    sin_lon_.resize(count);
+    cos_lon_.resize(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const StationFrame frame(stations[i]);
+        x_[i] = frame.Position().x;
+        y_[i] = frame.Position().y;
+        z_[i] = frame.Position().z;
+        sin_lat_[i] = frame.SinLatitude();
+        cos_lat_[i] = frame.CosLatitude();
+        sin_lon_[i] = frame.SinLongitude();
+        cos_lon_[i] = frame.CosLongitude();
+    }
+}
+
+void StationBlock::ToEci(
+        const DateTime& dt,
+        double gmst,
+        std::vector<Eci>& stations) const
+{
+    const double cos_gmst = cos(gmst);
+    const double sin_gmst = sin(gmst);
+
+    stations.clear();
+    stations.reserve(x_.size());
+    for (size_t i = 0; i < x_.size(); i++)
+    {
+        const Vector fixed(x_[i], y_[i], z_[i]);
+        Vector position;
+        Vector velocity;
+        StationFrame::ToEci(fixed, sin_gmst, cos_gmst, position, velocity);
+        stations.push_back(Eci(dt, position, velocity));
+    }
+}
+
+void StationBlock::LookAngles(
+        const Eci& eci,
+        double gmst,
+        double* azimuth,
+        double* elevation,
+        double* range,
+        double* range_rate) const
+{
+    /*
+     * rotate the satellite into the earth fixed frame, its velocity being
+     * relative to the turning earth
+     */
+    Vector position;
+    Vector velocity;
+    StationFrame::ToEarthFixed(eci.Position(), eci.Velocity(),
+            sin(gmst), cos(gmst), position, velocity);
+
+    const double px = position.x;
+    const double py = position.y;
+    const double pz = position.z;
+    const double vx = velocity.x;
+    const double vy = velocity.y;
+    const double vz = velocity.z;
+
+    const size_t count = x_.size();
+    for (size_t first = 0; first < count; first += kChunk)
+    {
+        const size_t n = std::min(kChunk, count - first);
+        const double* x = x_.data() + first;
+        const double* y = y_.data() + first;
+        const double* z = z_.data() + first;
+        const double* sin_lat = sin_lat_.data() + first;
+        const double* cos_lat = cos_lat_.data() + first;
+        const double* sin_lon = sin_lon_.data() + first;
+        const double* cos_lon = cos_lon_.data() + first;
+
+        /*
+         * components of the range in the local horizontal frame, and the
+         * range rate still to be divided by the range. only arithmetic into
+         * local arrays, so this loop vectorises
+         */
+        double east[kChunk];
+        double north[kChunk];
+        double up[kChunk];
+        double range2[kChunk];
+        double rate[kChunk];
+        for (size_t i = 0; i < n; i++)
+        {
+            const double rx = px - x[i];
+            const double ry = py - y[i];
+            const double rz = pz - z[i];
+
+            StationFrame::ToLocal(sin_lat[i], cos_lat[i], sin_lon[i],
+                    cos_lon[i], rx, ry, rz, east[i], north[i], up[i]);
+            range2[i] = rx * rx + ry * ry + rz * rz;
+            rate[i] = rx * vx + ry * vy + rz * vz;
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const double r = sqrt(range2[i]);
+            double az = atan2(east[i], north[i]);
+            if (az < 0.0)
+            {
+                az += kTWOPI;
+            }
+
+            azimuth[first + i] = az;
+            elevation[first + i] = asin(up[i] / r);
+            range[first + i] = r;
+            range_rate[first + i] = rate[i] / r;
+        }
+    }
+}
+
+void StationBlock::LookAngles(
+        const std::vector<Eci>& states,
+        double gmst,
+        LookAngleMatrix& matrix) const
+{
+    const size_t stations = Size();
+    const size_t size = states.size() * stations;
+
+    matrix.satellites = states.size();
+    matrix.stations = stations;
+    matrix.azimuth.resize(size);
+    matrix.elevation.resize(size);
+    matrix.range.resize(size);
+    matrix.range_rate.resize(size);
+
+    for (size_t i = 0; i < states.size(); i++)
+    {
+        const size_t row = i * stations;
+        LookAngles(states[i], gmst,
+                matrix.azimuth.data() + row,
+                matrix.elevation.data() + row,
+                matrix.range.data() + row,
+                matrix.range_rate.data() + row);
+    }
+}
+
+void StationBlock::LookAngles(
+        const std::vector<Eci>& states,
+        LookAngleMatrix& matrix) const
+{
+    double gmst = 0.0;
+    if (!states.empty())
+    {
+        gmst = states.front().GetDateTime().ToGreenwichSiderealTime();
+    }
+    LookAngles(states, gmst, matrix);
+}
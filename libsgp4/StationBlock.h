@@ -0,0 +1,155 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef STATIONBLOCK_H_
+#define STATIONBLOCK_H_
+
+#include "CoordGeodetic.h"
+#include "CoordTopocentric.h"
+#include "Eci.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Look angles from a block of stations to a block of satellites.
+ *
+ * Values are held satellite by satellite, each row holding the values for
+ * every station in order.
+ */
+struct LookAngleMatrix
+{
+    LookAngleMatrix()
+        : satellites(0)
+        , stations(0)
+    {
+    }
+
+    /**
+     * @param[in] satellite the satellite index
+     * @param[in] station the station index
+     * @returns the look angle from the station to the satellite
+     */
+    CoordTopocentric Get(size_t satellite, size_t station) const
+    {
+        const size_t i = satellite * stations + station;
+        return CoordTopocentric(azimuth[i], elevation[i], range[i],
+                range_rate[i]);
+    }
+
+    /** number of satellites */
+    size_t satellites;
+    /** number of stations */
+    size_t stations;
+    /** azimuths in radians */
+    std::vector<double> azimuth;
+    /** elevations in radians */
+    std::vector<double> elevation;
+    /** ranges in kilometres */
+    std::vector<double> range;
+    /** range rates in kilometres per second */
+    std::vector<double> range_rate;
+};
+
+/**
+ * @brief A set of stations held for working out look angles together.
+ *
+ * The earth fixed position and local axes of each station are worked out
+ * once, so placing the stations at a time needs only a rotation. Each
+ * satellite state is rotated into the earth fixed frame once per time, and
+ * the look angles to every station then come from simple loops over arrays
+ * of station values, which the compiler can vectorise. The results match
+ * Observer::GetLookAngle.
+ */
+class StationBlock
+{
+public:
+    /**
+     * Constructor
+     * @param[in] stations the station positions
+     */
+    explicit StationBlock(const std::vector<CoordGeodetic>& stations);
+
+    /**
+     * @returns the number of stations
+     */
+    size_t Size() const
+    {
+        return x_.size();
+    }
+
+    /**
+     * Find the inertial positions and velocities of every station at one
+     * time, as Eci would for each
+     * @param[in] dt the time
+     * @param[in] gmst the greenwich mean sidereal time of dt in radians
+     * @param[out] stations receives Size() station states
+     */
+    void ToEci(const DateTime& dt,
+            double gmst,
+            std::vector<Eci>& stations) const;
+
+    /**
+     * Work out the look angles from every station to one satellite
+     * @param[in] eci the satellite state
+     * @param[in] gmst the greenwich mean sidereal time of the state in radians
+     * @param[out] azimuth receives Size() azimuths in radians
+     * @param[out] elevation receives Size() elevations in radians
+     * @param[out] range receives Size() ranges in kilometres
+     * @param[out] range_rate receives Size() range rates in km/s
+     */
+    void LookAngles(const Eci& eci,
+            double gmst,
+            double* azimuth,
+            double* elevation,
+            double* range,
+            double* range_rate) const;
+
+    /**
+     * Work out the look angles from every station to satellites which are
+     * all at the same time
+     * @param[in] states the satellite states
+     * @param[in] gmst the greenwich mean sidereal time of the states in
+     *            radians
+     * @param[out] matrix receives the look angles
+     */
+    void LookAngles(const std::vector<Eci>& states,
+            double gmst,
+            LookAngleMatrix& matrix) const;
+
+    /**
+     * Work out the look angles from every station to satellites which are
+     * all at the same time
+     * @param[in] states the satellite states
+     * @param[out] matrix receives the look angles
+     */
+    void LookAngles(const std::vector<Eci>& states,
+            LookAngleMatrix& matrix) const;
+
+private:
+    /** earth fixed station positions in kilometres */
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> z_;
+    /** sines and cosines of the station latitudes and longitudes */
+    std::vector<double> sin_lat_;
+    std::vector<double> cos_lat_;
+    std::vector<double> sin_lon_;
+    std::vector<double> cos_lon_;
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "StationFrame.h"
+
+#include "Globals.h"
+
+#include <cmath>
+
+namespace
+{
+    static const double kEarthRate = kTWOPI * (kOMEGA_E / kSECONDS_PER_DAY);
+}
+
+StationFrame::StationFrame(const CoordGeodetic& geo)
+    : sin_lat_(sin(geo.latitude))
+    , cos_lat_(cos(geo.latitude))
+    , sin_lon_(sin(geo.longitude))
+    , cos_lon_(cos(geo.longitude))
+{
+    /*
+     * take into account earth flattening
+     */
+    const double c = 1.0
+        / sqrt(1.0 + kF * (kF - 2.0) * sin_lat_ * sin_lat_);
+    const double s = (1.0 - kF) * (1.0 - kF) * c;
+    const double achcp = (kXKMPER * c + geo.altitude) * cos_lat_;
+
+    position_ = Vector(achcp * cos_lon_,
+            achcp * sin_lon_,
+            (kXKMPER * s + geo.altitude) * sin_lat_);
+    position_.w = position_.Magnitude();
+}
+
+void StationFrame::ToEci(
+        const Vector& fixed,
+        double sin_gmst,
+        double cos_gmst,
+        Vector& position,
+        Vector& velocity)
+{
+    /*
+     * X position in km
+     * Y position in km
+     * Z position in km
+     * W magnitude in km
+     */
+    position.x = cos_gmst * fixed.x - sin_gmst * fixed.y;
+    position.y = sin_gmst * fixed.x + cos_gmst * fixed.y;
+    position.z = fixed.z;
+    position.w = fixed.w;
+
+    /*
+     * X velocity in km/s
+     * Y velocity in km/s
+     * Z velocity in km/s
+     * W magnitude in km/s
+     */
+    velocity.x = -kEarthRate * position.y;
+    velocity.y = kEarthRate * position.x;
+    velocity.z = 0.0;
+    velocity.w = velocity.Magnitude();
+}
+
+void StationFrame::ToEarthFixed(
+        const Vector& position,
+        const Vector& velocity,
+        double sin_gmst,
+        double cos_gmst,
+        Vector& fixed_position,
+        Vector& fixed_velocity)
+{
+    fixed_position = ToEarthFixed(position, sin_gmst, cos_gmst);
+
+    /*
+     * take away the velocity of the earth fixed axes at the position
+     */
+    fixed_velocity = ToEarthFixed(velocity, sin_gmst, cos_gmst);
+    fixed_velocity.x += kEarthRate * fixed_position.y;
+    fixed_velocity.y -= kEarthRate * fixed_position.x;
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef STATIONFRAME_H_
+#define STATIONFRAME_H_
+
+#include "CoordGeodetic.h"
+#include "Vector.h"
+
+/**
+ * @brief A station's position fixed to the earth, and its local axes.
+ *
+ * Everything that depends only on the station's latitude, longitude and
+ * altitude is worked out once, leaving a rotation by the sidereal time to
+ * place the station at any particular time. Satellites are looked at from
+ * the station by rotating them into earth fixed axes with ToEarthFixed,
+ * taking the station position away and projecting the result onto the
+ * local axes with ToLocal. Everything that works out look angles does so
+ * through these, so that there is one copy of each step.
+ */
+class StationFrame
+{
+public:
+    /**
+     * Constructor
+     * @param[in] geo the station position
+     */
+    explicit StationFrame(const CoordGeodetic& geo);
+
+    /**
+     * @returns the earth fixed position in kilometres
+     */
+    const Vector& Position() const
+    {
+        return position_;
+    }
+
+    double SinLatitude() const
+    {
+        return sin_lat_;
+    }
+
+    double CosLatitude() const
+    {
+        return cos_lat_;
+    }
+
+    double SinLongitude() const
+    {
+        return sin_lon_;
+    }
+
+    double CosLongitude() const
+    {
+        return cos_lon_;
+    }
+
+    /**
+     * Find the inertial position and velocity of the station
+     * @param[in] sin_gmst the sine of the greenwich mean sidereal time
+     * @param[in] cos_gmst the cosine of the greenwich mean sidereal time
+     * @param[out] position receives the position in kilometres
+     * @param[out] velocity receives the velocity in kilometres per second
+     */
+    void ToEci(double sin_gmst,
+            double cos_gmst,
+            Vector& position,
+            Vector& velocity) const
+    {
+        ToEci(position_, sin_gmst, cos_gmst, position, velocity);
+    }
+
+    /**
+     * Find the inertial position and velocity of a point fixed to the earth
+     * @param[in] fixed the earth fixed position in kilometres
+     * @param[in] sin_gmst the sine of the greenwich mean sidereal time
+     * @param[in] cos_gmst the cosine of the greenwich mean sidereal time
+     * @param[out] position receives the position in kilometres
+     * @param[out] velocity receives the velocity in kilometres per second
+     */
+    static void ToEci(const Vector& fixed,
+            double sin_gmst,
+            double cos_gmst,
+            Vector& position,
+            Vector& velocity);
+
+    /**
+     * Rotate an inertial position into earth fixed axes
+     * @param[in] position the inertial position
+     * @param[in] sin_gmst the sine of the greenwich mean sidereal time
+     * @param[in] cos_gmst the cosine of the greenwich mean sidereal time
+     * @returns the earth fixed position, without its magnitude
+     */
+    static Vector ToEarthFixed(const Vector& position,
+            double sin_gmst,
+            double cos_gmst)
+    {
+        return Vector(cos_gmst * position.x + sin_gmst * position.y,
+                -sin_gmst * position.x + cos_gmst * position.y,
+                position.z);
+    }
+
+    /**
+     * Rotate an inertial position and velocity into earth fixed axes. The
+     * velocity becomes relative to the turning earth.
+     * @param[in] position the inertial position in kilometres
+     * @param[in] velocity the inertial velocity in kilometres per second
+     * @param[in] sin_gmst the sine of the greenwich mean sidereal time
+     * @param[in] cos_gmst the cosine of the greenwich mean sidereal time
+     * @param[out] fixed_position receives the earth fixed position
+     * @param[out] fixed_velocity receives the earth relative velocity
+     */
+    static void ToEarthFixed(const Vector& position,
+            const Vector& velocity,
+            double sin_gmst,
+            double cos_gmst,
+            Vector& fixed_position,
+            Vector& fixed_velocity);
+
+    /**
+     * Project a vector in earth fixed axes onto the station's east, north
+     * and up axes
+     * @param[in] v the vector
+     * @param[out] east receives the east component
+     * @param[out] north receives the north component
+     * @param[out] up receives the up component
+     */
+    void ToLocal(const Vector& v,
+            double& east,
+            double& north,
+            double& up) const
+    {
+        ToLocal(sin_lat_, cos_lat_, sin_lon_, cos_lon_,
+                v.x, v.y, v.z, east, north, up);
+    }
+
+    /**
+     * Project a vector in earth fixed axes onto the east, north and up axes
+     * of a station given by the sines and cosines of its latitude and
+     * longitude. Inline so that loops over many stations can vectorise.
+     */
+    static void ToLocal(double sin_lat,
+            double cos_lat,
+            double sin_lon,
+            double cos_lon,
+            double x,
+            double y,
+            double z,
+            double& east,
+            double& north,
+            double& up)
+    {
+        const double radial = cos_lon * x + sin_lon * y;
+        east = -sin_lon * x + cos_lon * y;
+        north = -sin_lat * radial + cos_lat * z;
+        up = cos_lat * radial + sin_lat * z;
+    }
+
+private:
+    Vector position_;
+    double sin_lat_;
+    double cos_lat_;
+    double sin_lon_;
+    double cos_lon_;
+};
+
+#endif
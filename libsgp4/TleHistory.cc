@@ -0,0 +1,443 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "TleHistory.h"
+
+#include "SGP4.h"
+#include "SatelliteException.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    static const char kHistoryMagic[8] = { 'S', 'G', 'P', '4', 'H', 'S', 'T', '\0' };
+    static const uint32_t kHistoryVersion = 1;
+
+    /*
+     * orders element sets by satellite then epoch
+     */
+    struct TleOrder
+    {
+        bool operator()(const Tle* tle1, const Tle* tle2) const
+        {
+            if (tle1->NoradNumber() != tle2->NoradNumber())
+            {
+                return tle1->NoradNumber() < tle2->NoradNumber();
+            }
+            return tle1->Epoch() < tle2->Epoch();
+        }
+    };
+}
+
+TleHistory::TleHistory()
+    : satellites_(NULL)
+    , epochs_(NULL)
+    , records_(NULL)
+    , num_satellites_(0)
+    , num_records_(0)
+    , mapping_(NULL)
+    , mapping_size_(0)
+{
+}
+
+TleHistory::TleHistory(const std::vector<Tle>& tles)
+    : satellites_(NULL)
+    , epochs_(NULL)
+    , records_(NULL)
+    , num_satellites_(0)
+    , num_records_(0)
+    , mapping_(NULL)
+    , mapping_size_(0)
+{
+    std::vector<const Tle*> sorted;
+    sorted.reserve(tles.size());
+    for (size_t i = 0; i < tles.size(); i++)
+    {
+        sorted.push_back(&tles[i]);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), TleOrder());
+
+    /*
+     * drop duplicate epochs, keeping the last one given
+     */
+    std::vector<const Tle*> unique;
+    unique.reserve(sorted.size());
+    for (size_t i = 0; i < sorted.size(); i++)
+    {
+        if (!unique.empty()
+                && unique.back()->NoradNumber() == sorted[i]->NoradNumber()
+                && unique.back()->Epoch() == sorted[i]->Epoch())
+        {
+            unique.back() = sorted[i];
+        }
+        else
+        {
+            unique.push_back(sorted[i]);
+        }
+    }
+
+    std::vector<SatelliteIndex> satellites;
+    for (size_t i = 0; i < unique.size(); i++)
+    {
+        if (satellites.empty()
+                || satellites.back().norad_number != unique[i]->NoradNumber())
+        {
+            SatelliteIndex index;
+            index.norad_number = unique[i]->NoradNumber();
+            index.reserved = 0;
+            index.first = i;
+            index.count = 0;
+            satellites.push_back(index);
+        }
+        satellites.back().count++;
+    }
+
+    num_satellites_ = satellites.size();
+    num_records_ = unique.size();
+
+    /*
+     * lay the buffer out as it is stored on disk
+     */
+    const size_t satellites_size = num_satellites_ * sizeof(SatelliteIndex);
+    const size_t epochs_size = num_records_ * sizeof(int64_t);
+    const size_t records_size = num_records_ * sizeof(Record);
+    buffer_.resize(satellites_size + epochs_size + records_size);
+
+    char* satellites_ptr = buffer_.data();
+    char* epochs_ptr = satellites_ptr + satellites_size;
+    char* records_ptr = epochs_ptr + epochs_size;
+
+    if (satellites_size > 0)
+    {
+        std::memcpy(satellites_ptr, satellites.data(), satellites_size);
+    }
+
+    for (size_t i = 0; i < unique.size(); i++)
+    {
+        const Tle& tle = *unique[i];
+        Record record;
+        record.epoch = tle.Epoch().Ticks();
+        record.mean_anomoly = tle.MeanAnomaly(false);
+        record.ascending_node = tle.RightAscendingNode(false);
+        record.argument_perigee = tle.ArgumentPerigee(false);
+        record.eccentricity = tle.Eccentricity();
+        record.inclination = tle.Inclination(false);
+        record.mean_motion = tle.MeanMotion() * kTWOPI / kMINUTES_PER_DAY;
+        record.bstar = tle.BStar();
+
+        std::memcpy(epochs_ptr + i * sizeof(int64_t),
+                &record.epoch, sizeof(int64_t));
+        std::memcpy(records_ptr + i * sizeof(Record),
+                &record, sizeof(Record));
+    }
+
+    SetPointers(satellites_ptr, epochs_ptr, records_ptr);
+}
+
+TleHistory::~TleHistory()
+{
+    Clear();
+}
+
+void TleHistory::Clear()
+{
+#ifndef _WIN32
+    if (mapping_ != NULL)
+    {
+        munmap(mapping_, mapping_size_);
+    }
+#endif
+    mapping_ = NULL;
+    mapping_size_ = 0;
+    buffer_.clear();
+
+    satellites_ = NULL;
+    epochs_ = NULL;
+    records_ = NULL;
+    num_satellites_ = 0;
+    num_records_ = 0;
+}
+
+void TleHistory::SetPointers(const char* satellites,
+        const char* epochs,
+        const char* records)
+{
+    satellites_ = reinterpret_cast<const SatelliteIndex*>(satellites);
+    epochs_ = reinterpret_cast<const int64_t*>(epochs);
+    records_ = reinterpret_cast<const Record*>(records);
+}
+
+void TleHistory::Save(const std::string& path) const
+{
+    FileHeader header;
+    std::memcpy(header.magic, kHistoryMagic, sizeof(header.magic));
+    header.version = kHistoryVersion;
+    header.record_size = sizeof(Record);
+    header.num_satellites = num_satellites_;
+    header.num_records = num_records_;
+
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open history file for writing");
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(satellites_),
+            num_satellites_ * sizeof(SatelliteIndex));
+    file.write(reinterpret_cast<const char*>(epochs_),
+            num_records_ * sizeof(int64_t));
+    file.write(reinterpret_cast<const char*>(records_),
+            num_records_ * sizeof(Record));
+
+    if (!file.good())
+    {
+        throw std::runtime_error("Failed to write history file");
+    }
+}
+
+void TleHistory::Map(const std::string& path)
+{
+    Clear();
+
+    const char* data = NULL;
+    size_t size = 0;
+
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Failed to open history file");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader)))
+    {
+        close(fd);
+        throw std::runtime_error("Invalid history file");
+    }
+
+    size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Failed to map history file");
+    }
+
+    mapping_ = mapping;
+    mapping_size_ = size;
+    data = static_cast<const char*>(mapping);
+#else
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open history file");
+    }
+    buffer_.assign(std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+    size = buffer_.size();
+    data = buffer_.data();
+#endif
+
+    FileHeader header;
+    if (size < sizeof(header))
+    {
+        Clear();
+        throw std::runtime_error("Invalid history file");
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, kHistoryMagic, sizeof(header.magic)) != 0
+            || header.version != kHistoryVersion
+            || header.record_size != sizeof(Record))
+    {
+        Clear();
+        throw std::runtime_error("Invalid history file");
+    }
+
+    /*
+     * check the counts against the size by division, so that counts from
+     * a corrupt header cannot overflow the sizes they imply
+     */
+    const uint64_t body_size = size - sizeof(FileHeader);
+    const uint64_t record_bytes = sizeof(int64_t) + sizeof(Record);
+    if (header.num_satellites > body_size / sizeof(SatelliteIndex))
+    {
+        Clear();
+        throw std::runtime_error("Invalid history file");
+    }
+
+    const uint64_t records_size =
+        body_size - header.num_satellites * sizeof(SatelliteIndex);
+    if (records_size % record_bytes != 0
+            || records_size / record_bytes != header.num_records)
+    {
+        Clear();
+        throw std::runtime_error("Invalid history file");
+    }
+
+    const char* satellites = data + sizeof(FileHeader);
+    const char* epochs =
+        satellites + header.num_satellites * sizeof(SatelliteIndex);
+    if (!IsValidIndex(reinterpret_cast<const SatelliteIndex*>(satellites),
+                reinterpret_cast<const int64_t*>(epochs),
+                header.num_satellites, header.num_records))
+    {
+        Clear();
+        throw std::runtime_error("Invalid history file");
+    }
+
+    num_satellites_ = header.num_satellites;
+    num_records_ = header.num_records;
+
+    const char* records = epochs + num_records_ * sizeof(int64_t);
+    SetPointers(satellites, epochs, records);
+}
+
+/*
+ * Find searches the index by norad number and then the epochs of the
+ * satellite, so each satellite must have element sets lying within the
+ * file, the norad numbers must ascend and so must each satellite's epochs
+ */
+bool TleHistory::IsValidIndex(const SatelliteIndex* satellites,
+        const int64_t* epochs,
+        uint64_t num_satellites,
+        uint64_t num_records)
+{
+    for (uint64_t i = 0; i < num_satellites; i++)
+    {
+        const SatelliteIndex& index = satellites[i];
+        if (index.count == 0
+                || index.first > num_records
+                || index.count > num_records - index.first)
+        {
+            return false;
+        }
+        if (i > 0 && satellites[i - 1].norad_number >= index.norad_number)
+        {
+            return false;
+        }
+        for (uint64_t j = index.first + 1; j < index.first + index.count; j++)
+        {
+            if (epochs[j - 1] >= epochs[j])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+const TleHistory::Record* TleHistory::Find(unsigned int norad_number,
+        const DateTime& dt,
+        LookupMode mode) const
+{
+    /*
+     * find the satellite
+     */
+    const SatelliteIndex* sat_begin = satellites_;
+    const SatelliteIndex* sat_end = satellites_ + num_satellites_;
+    const SatelliteIndex* sat = std::lower_bound(sat_begin, sat_end,
+            norad_number,
+            [](const SatelliteIndex& index, unsigned int norad)
+            {
+                return index.norad_number < norad;
+            });
+
+    if (sat == sat_end || sat->norad_number != norad_number)
+    {
+        return NULL;
+    }
+
+    /*
+     * find the first element set with an epoch after dt
+     */
+    const int64_t* first = epochs_ + sat->first;
+    const int64_t* last = first + sat->count;
+    const int64_t* after = std::upper_bound(first, last, dt.Ticks());
+
+    if (mode == CLOSEST)
+    {
+        if (after == first)
+        {
+            return records_ + sat->first;
+        }
+        if (after == last
+                || dt.Ticks() - *(after - 1) <= *after - dt.Ticks())
+        {
+            --after;
+        }
+        return records_ + (after - epochs_);
+    }
+
+    if (after == first)
+    {
+        return NULL;
+    }
+    return records_ + (after - 1 - epochs_);
+}
+
+Eci TleHistory::FindPosition(unsigned int norad_number,
+        const DateTime& dt,
+        LookupMode mode) const
+{
+    const Record* record = Find(norad_number, dt, mode);
+    if (record == NULL)
+    {
+        throw SatelliteException("No element set for satellite");
+    }
+
+    SGP4 sgp4(record->Elements());
+    return sgp4.FindPosition(dt);
+}
+
+Eci TleHistory::FindPosition(unsigned int norad_number,
+        const DateTime& dt,
+        PropagatorCache& cache,
+        LookupMode mode) const
+{
+    const Record* record = Find(norad_number, dt, mode);
+    if (record == NULL)
+    {
+        throw SatelliteException("No element set for satellite");
+    }
+
+    /*
+     * compare the elements rather than the address, which a history mapped
+     * again may reuse for different ones
+     */
+    if (!cache.sgp4_
+            || std::memcmp(&cache.record_, record, sizeof(Record)) != 0)
+    {
+        cache.sgp4_.reset(new SGP4(record->Elements()));
+        cache.record_ = *record;
+        cache.integrator_ = SGP4::IntegratorParams();
+    }
+    return cache.sgp4_->FindPosition(dt, cache.integrator_);
+}
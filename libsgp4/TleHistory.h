@@ -0,0 +1,253 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TLEHISTORY_H_
+#define TLEHISTORY_H_
+
+#include "Tle.h"
+#include "OrbitalElements.h"
+#include "Eci.h"
+#include "SGP4.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * @brief Historical element sets for many satellites, indexed by epoch.
+ *
+ * Each satellite's element sets are stored as a sorted array of epoch ticks
+ * alongside fixed size element records, so finding the element set for a
+ * given time is a binary search. The store can be saved to a file and later
+ * mapped read only into memory instead of being rebuilt.
+ */
+class TleHistory
+{
+public:
+    /**
+     * @brief The elements needed to initialise a propagator.
+     */
+    struct Record
+    {
+        /** epoch in ticks */
+        int64_t epoch;
+        /** mean anomoly in radians */
+        double mean_anomoly;
+        /** right ascension of the ascending node in radians */
+        double ascending_node;
+        /** argument of perigee in radians */
+        double argument_perigee;
+        /** eccentricity */
+        double eccentricity;
+        /** inclination in radians */
+        double inclination;
+        /** mean motion in radians per minute */
+        double mean_motion;
+        /** BSTAR drag term */
+        double bstar;
+
+        /**
+         * @returns the record as orbital elements
+         */
+        OrbitalElements Elements() const
+        {
+            return OrbitalElements(DateTime(epoch),
+                    mean_anomoly,
+                    ascending_node,
+                    argument_perigee,
+                    eccentricity,
+                    inclination,
+                    mean_motion,
+                    bstar);
+        }
+    };
+
+    /**
+     * @brief The propagator for the element set a caller last used.
+     *
+     * FindPosition without a cache initialises a propagator on every call,
+     * so that a const history may be shared between threads. A caller
+     * propagating satellites over a period can keep a cache and pass it to
+     * each call, so that a propagator is only initialised when the element
+     * set chosen changes, and the resonance integration of a deep space
+     * orbit carries on from the last call. A cache must be used by one
+     * thread at a time.
+     */
+    class PropagatorCache
+    {
+    public:
+        PropagatorCache()
+            : record_()
+        {
+        }
+
+    private:
+        friend class TleHistory;
+
+        Record record_;
+        std::unique_ptr<SGP4> sgp4_;
+        SGP4::IntegratorParams integrator_;
+    };
+
+    /**
+     * How to choose an element set for a given time
+     */
+    enum LookupMode
+    {
+        /** the latest element set with an epoch at or before the time */
+        LATEST_BEFORE,
+        /** the element set with the epoch closest to the time */
+        CLOSEST
+    };
+
+    /**
+     * Create an empty history
+     */
+    TleHistory();
+
+    /**
+     * Create a history from a set of element sets. Element sets for the same
+     * satellite with the same epoch are stored once.
+     * @param[in] tles the element sets
+     */
+    explicit TleHistory(const std::vector<Tle>& tles);
+
+    ~TleHistory();
+
+    /**
+     * Write the history to a file which may later be passed to Map. The file
+     * uses the native byte order.
+     * @param[in] path the file to write
+     * @exception std::runtime_error on failure
+     */
+    void Save(const std::string& path) const;
+
+    /**
+     * Replace the contents of this history with a file written by Save. The
+     * file is mapped read only where supported, otherwise it is read. The
+     * header and satellite index are checked against the file size and
+     * each satellite's epochs must ascend, but the element sets themselves
+     * are not read until used.
+     * @param[in] path the file to map
+     * @exception std::runtime_error on failure or if the file is invalid
+     */
+    void Map(const std::string& path);
+
+    /**
+     * Find the element set for a satellite at a given time
+     * @param[in] norad_number the satellite
+     * @param[in] dt the time
+     * @param[in] mode how to choose between element sets
+     * @returns the record, or NULL if there is no suitable element set
+     */
+    const Record* Find(unsigned int norad_number,
+            const DateTime& dt,
+            LookupMode mode = LATEST_BEFORE) const;
+
+    /**
+     * Propagate a satellite using the element set chosen for the given time
+     * @param[in] norad_number the satellite
+     * @param[in] dt the time
+     * @param[in] mode how to choose between element sets
+     * @returns the position of the satellite
+     * @exception SatelliteException if there is no suitable element set
+     */
+    Eci FindPosition(unsigned int norad_number,
+            const DateTime& dt,
+            LookupMode mode = LATEST_BEFORE) const;
+
+    /**
+     * Propagate a satellite using the element set chosen for the given
+     * time, reusing the propagator held by a cache while the element set
+     * stays the same. Results are the same as without the cache.
+     * @param[in] norad_number the satellite
+     * @param[in] dt the time
+     * @param[in,out] cache the propagator last used by the caller
+     * @param[in] mode how to choose between element sets
+     * @returns the position of the satellite
+     * @exception SatelliteException if there is no suitable element set
+     */
+    Eci FindPosition(unsigned int norad_number,
+            const DateTime& dt,
+            PropagatorCache& cache,
+            LookupMode mode = LATEST_BEFORE) const;
+
+    /**
+     * @returns the number of satellites
+     */
+    size_t SatelliteCount() const
+    {
+        return num_satellites_;
+    }
+
+    /**
+     * @returns the total number of element sets
+     */
+    size_t RecordCount() const
+    {
+        return num_records_;
+    }
+
+private:
+    TleHistory(const TleHistory&) = delete;
+    TleHistory& operator=(const TleHistory&) = delete;
+
+    /*
+     * element sets for one satellite are stored at [first, first + count)
+     */
+    struct SatelliteIndex
+    {
+        uint32_t norad_number;
+        uint32_t reserved;
+        uint64_t first;
+        uint64_t count;
+    };
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t record_size;
+        uint64_t num_satellites;
+        uint64_t num_records;
+    };
+
+    void Clear();
+    static bool IsValidIndex(const SatelliteIndex* satellites,
+            const int64_t* epochs,
+            uint64_t num_satellites,
+            uint64_t num_records);
+    void SetPointers(const char* satellites,
+            const char* epochs,
+            const char* records);
+
+    /*
+     * points into either the owned buffer or the mapped file
+     */
+    const SatelliteIndex* satellites_;
+    const int64_t* epochs_;
+    const Record* records_;
+    uint64_t num_satellites_;
+    uint64_t num_records_;
+
+    std::vector<char> buffer_;
+    void* mapping_;
+    size_t mapping_size_;
+};
+
+#endif
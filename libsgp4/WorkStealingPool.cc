@@ -0,0 +1,158 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    /*
+     * the owner works forward through its range
+     */
+    bool TakeOwn(Worker& worker, size_t& task)
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty())
+        {
+            return false;
+        }
+        task = worker.tasks.front();
+        worker.tasks.pop_front();
+        return true;
+    }
+
+    /*
+     * thieves take from the back, away from the owner
+     */
+    bool Steal(Worker& worker, size_t& task)
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty())
+        {
+            return false;
+        }
+        task = worker.tasks.back();
+        worker.tasks.pop_back();
+        return true;
+    }
+}
+
+WorkStealingPool::WorkStealingPool(unsigned int thread_count)
+    : thread_count_(thread_count)
+{
+    if (thread_count_ == 0)
+    {
+        thread_count_ = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+}
+
+void WorkStealingPool::Run(
+        size_t count,
+        const std::function<void(size_t)>& task) const
+{
+    std::vector<std::exception_ptr> errors(count);
+
+    const size_t worker_count = std::min<size_t>(thread_count_, count);
+    if (worker_count <= 1)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            try
+            {
+                task(i);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        }
+    }
+    else
+    {
+        std::vector<Worker> workers(worker_count);
+        for (size_t w = 0; w < worker_count; w++)
+        {
+            const size_t first = w * count / worker_count;
+            const size_t last = (w + 1) * count / worker_count;
+            for (size_t i = first; i < last; i++)
+            {
+                workers[w].tasks.push_back(i);
+            }
+        }
+
+        /*
+         * no tasks are added once running, so a worker which finds every
+         * queue empty is done
+         */
+        std::function<void(size_t)> work = [&](size_t self)
+        {
+            size_t current;
+            while (true)
+            {
+                bool found = TakeOwn(workers[self], current);
+                for (size_t i = 1; !found && i < worker_count; i++)
+                {
+                    found = Steal(workers[(self + i) % worker_count], current);
+                }
+                if (!found)
+                {
+                    break;
+                }
+
+                try
+                {
+                    task(current);
+                }
+                catch (...)
+                {
+                    errors[current] = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_t w = 1; w < worker_count; w++)
+        {
+            threads.push_back(std::thread(work, w));
+        }
+        work(0);
+        for (size_t i = 0; i < threads.size(); i++)
+        {
+            threads[i].join();
+        }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (errors[i])
+        {
+            std::rethrow_exception(errors[i]);
+        }
+    }
+}
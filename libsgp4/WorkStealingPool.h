@@ -0,0 +1,63 @@
+/*
+ * Copyright 2013 Daniel Warner <contact@danrw.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef WORKSTEALINGPOOL_H_
+#define WORKSTEALINGPOOL_H_
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * @brief Runs a set of independent tasks across a number of threads.
+ *
+ * The tasks are dealt out to the workers in contiguous ranges up front.
+ * A worker that runs out takes tasks from the far end of another workers
+ * range, so tasks of very different cost still balance.
+ */
+class WorkStealingPool
+{
+public:
+    /**
+     * Constructor
+     * @param[in] thread_count the number of threads to run tasks on, or zero
+     *            for the number of hardware threads
+     */
+    explicit WorkStealingPool(unsigned int thread_count = 0);
+
+    /**
+     * @returns the number of threads tasks are run on
+     */
+    unsigned int ThreadCount() const
+    {
+        return thread_count_;
+    }
+
+    /**
+     * Run task(i) for every i in [0, count), returning once all have
+     * finished. Tasks must not depend on each other.
+     * @param[in] count the number of tasks
+     * @param[in] task the function to run for each task index
+     * @exception rethrows the exception thrown by the lowest numbered
+     *            failing task, after all tasks have finished
+     */
+    void Run(size_t count, const std::function<void(size_t)>& task) const;
+
+private:
+    unsigned int thread_count_;
+};
+
+#endif